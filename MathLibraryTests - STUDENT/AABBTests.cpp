@@ -0,0 +1,131 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/AABB.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::AABB;
+using ::MathClasses::Matrix4;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector4;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(AABBTests)
+	{
+	public:
+		// the slow way, by transforming all eight corners
+		static AABB TransformCorners(const AABB& box, const Matrix4& m)
+		{
+			AABB result;
+			for (int corner = 0; corner < 8; ++corner) {
+				Vector4 p((corner & 1) ? box.max.x : box.min.x, (corner & 2) ? box.max.y : box.min.y, (corner & 4) ? box.max.z : box.min.z, 1);
+				Vector4 t = m * p;
+				result.Expand(Vector3(t.x, t.y, t.z));
+			}
+			return result;
+		}
+
+		static Matrix4 MakeTestMatrix()
+		{
+			Matrix4 m = Matrix4::MakeEuler(0.7f, -1.3f, 2.1f);
+			m.axis[0] *= 2.0f;
+			m.axis[2] *= -0.5f;
+			m.axis[3] = Vector4(10, -4, 3, 1);
+			return m;
+		}
+
+		TEST_METHOD(DefaultIsEmpty)
+		{
+			AABB box;
+			Assert::IsTrue(box.IsEmpty());
+			Assert::IsFalse(box.Contains(Vector3(0, 0, 0)));
+			Assert::IsFalse(box.Overlaps(AABB(Vector3(-1, -1, -1), Vector3(1, 1, 1))));
+			Assert::AreEqual(0.0f, box.SurfaceArea());
+			Assert::AreEqual(AABB::MakeEmpty(), box.Transformed(MakeTestMatrix()));
+		}
+
+		TEST_METHOD(Properties)
+		{
+			AABB box(Vector3(-1, 2, 0), Vector3(3, 4, 1));
+			Assert::AreEqual(Vector3(1, 3, 0.5f), box.Centre());
+			Assert::AreEqual(Vector3(2, 1, 0.5f), box.Extents());
+			Assert::AreEqual(Vector3(4, 2, 1), box.Size());
+			Assert::AreEqual(2.0f * (8 + 2 + 4), box.SurfaceArea());
+			Assert::AreEqual(box, AABB::MakeCentreExtents(box.Centre(), box.Extents()));
+		}
+
+		TEST_METHOD(Merge)
+		{
+			Vector3 points[3] = { Vector3(1, 5, -2), Vector3(-3, 0, 0), Vector3(2, 2, 8) };
+			AABB box = AABB::MakeFromPoints(points, 3);
+			Assert::AreEqual(AABB(Vector3(-3, 0, -2), Vector3(2, 5, 8)), box);
+
+			AABB other(Vector3(0, -1, 0), Vector3(10, 1, 1));
+			Assert::AreEqual(AABB(Vector3(-3, -1, -2), Vector3(10, 5, 8)), box.Merge(other));
+			Assert::AreEqual(box, box.Merge(AABB()));
+
+			AABB boxes[2] = { box, other };
+			Assert::AreEqual(box.Merge(other), AABB::Merge(boxes, 2));
+		}
+
+		TEST_METHOD(ContainsAndOverlaps)
+		{
+			AABB box(Vector3(0, 0, 0), Vector3(2, 2, 2));
+
+			Assert::IsTrue(box.Contains(Vector3(1, 1, 1)));
+			Assert::IsTrue(box.Contains(Vector3(2, 0, 1)));
+			Assert::IsFalse(box.Contains(Vector3(2.1f, 1, 1)));
+
+			Assert::IsTrue(box.Contains(AABB(Vector3(0.5f, 0.5f, 0.5f), Vector3(1, 1, 1))));
+			Assert::IsFalse(box.Contains(AABB(Vector3(0.5f, 0.5f, 0.5f), Vector3(3, 1, 1))));
+
+			// sharing a face counts as overlapping
+			Assert::IsTrue(box.Overlaps(AABB(Vector3(2, 0, 0), Vector3(3, 1, 1))));
+			Assert::IsTrue(box.Overlaps(AABB(Vector3(-1, -1, -1), Vector3(5, 5, 5))));
+			Assert::IsFalse(box.Overlaps(AABB(Vector3(0, 3, 0), Vector3(1, 4, 1))));
+
+			AABB boxes[3] = { AABB(Vector3(1, 1, 1), Vector3(3, 3, 3)), AABB(Vector3(5, 5, 5), Vector3(6, 6, 6)), AABB() };
+			bool results[3];
+			AABB::Overlaps(box, boxes, results, 3);
+			Assert::IsTrue(results[0]);
+			Assert::IsFalse(results[1]);
+			Assert::IsFalse(results[2]);
+		}
+
+		TEST_METHOD(TransformedMatchesCorners)
+		{
+			AABB box(Vector3(-1, 2, 0.5f), Vector3(3, 4, 6));
+			Matrix4 m = MakeTestMatrix();
+
+			AABB expected = TransformCorners(box, m);
+			AABB actual = box.Transformed(m);
+			Assert::AreEqual(expected.min.x, actual.min.x, 0.0001f);
+			Assert::AreEqual(expected.min.y, actual.min.y, 0.0001f);
+			Assert::AreEqual(expected.min.z, actual.min.z, 0.0001f);
+			Assert::AreEqual(expected.max.x, actual.max.x, 0.0001f);
+			Assert::AreEqual(expected.max.y, actual.max.y, 0.0001f);
+			Assert::AreEqual(expected.max.z, actual.max.z, 0.0001f);
+
+			Assert::AreEqual(box, box.Transformed(Matrix4::MakeIdentity()));
+		}
+
+		TEST_METHOD(TransformBatch)
+		{
+			AABB boxes[3] = { AABB(Vector3(-1, 2, 0.5f), Vector3(3, 4, 6)), AABB(Vector3(0, 0, 0), Vector3(1, 1, 1)), AABB() };
+			Matrix4 matrices[3] = { MakeTestMatrix(), Matrix4::MakeRotateZ(0.5f), MakeTestMatrix() };
+
+			AABB out[3];
+			AABB::Transform(boxes, matrices, out, 3);
+			for (int i = 0; i < 3; ++i) {
+				Assert::AreEqual(boxes[i].Transformed(matrices[i]), out[i]);
+			}
+
+			// in place, one matrix for everything
+			AABB::Transform(boxes, matrices[0], boxes, 3);
+			Assert::AreEqual(out[0], boxes[0]);
+			Assert::AreEqual(out[2], boxes[2]);
+		}
+	};
+}
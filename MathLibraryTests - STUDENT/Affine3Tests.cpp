@@ -0,0 +1,132 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/Affine3.h"
+#include "MathHeaders/Quaternion.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::Affine3;
+using ::MathClasses::Matrix4;
+using ::MathClasses::Quaternion;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector4;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(Affine3Tests)
+	{
+	public:
+		static Matrix4 MakeTransform(float seed)
+		{
+			return Matrix4::MakeTRS(Vector3(seed, -2.0f * seed, 3.0f),
+				Quaternion::MakeEuler(seed * 0.3f, seed * -0.7f, 1.1f),
+				Vector3(1.0f + seed * 0.1f, 0.5f, 2.0f));
+		}
+
+		static Vector3 TransformByMatrix(const Matrix4& m, const Vector3& p, float w)
+		{
+			Vector4 r = m * Vector4(p.x, p.y, p.z, w);
+			return Vector3(r.x, r.y, r.z);
+		}
+
+		TEST_METHOD(DefaultIsIdentity)
+		{
+			Affine3 a;
+			Assert::AreEqual(Matrix4::MakeIdentity(), a.ToMatrix4());
+			Assert::AreEqual(Vector3(1, 2, 3), a.TransformPoint(Vector3(1, 2, 3)));
+			Assert::AreEqual((size_t)48, sizeof(Affine3));
+		}
+
+		TEST_METHOD(MatrixRoundTrip)
+		{
+			Matrix4 m = MakeTransform(1.5f);
+			Affine3 a = Affine3::MakeFromMatrix(m);
+
+			// exactly the same floats back
+			Matrix4 back = a.ToMatrix4();
+			for (int i = 0; i < 16; ++i) {
+				Assert::AreEqual(m.v[i], back.v[i]);
+			}
+			Assert::AreEqual(Vector3(1.5f, -3.0f, 3.0f), a.GetTranslation());
+
+			// rows are the matrix rows
+			Assert::AreEqual(m.m1, a.rows[0].x);
+			Assert::AreEqual(m.m5, a.rows[0].y);
+			Assert::AreEqual(m.m13, a.rows[0].w);
+			Assert::AreEqual(m.m15, a.rows[2].w);
+
+			Matrix4 matrices[2] = { m, MakeTransform(-0.5f) };
+			Affine3 affines[2];
+			Matrix4 backs[2];
+			Affine3::MakeFromMatrix(matrices, affines, 2);
+			Affine3::ToMatrix4(affines, backs, 2);
+			Assert::AreEqual(matrices[0], backs[0]);
+			Assert::AreEqual(matrices[1], backs[1]);
+		}
+
+		TEST_METHOD(Multiply)
+		{
+			Matrix4 ma = MakeTransform(0.7f), mb = MakeTransform(-1.3f);
+			Affine3 a = Affine3::MakeFromMatrix(ma), b = Affine3::MakeFromMatrix(mb);
+
+			Assert::AreEqual(ma * mb, (a * b).ToMatrix4());
+
+			// b first
+			Vector3 p(0.5f, -1.5f, 2.0f);
+			Assert::AreEqual(a.TransformPoint(b.TransformPoint(p)), (a * b).TransformPoint(p));
+
+			Affine3 c = a;
+			c *= b;
+			Assert::AreEqual(a * b, c);
+
+			// batch, in place
+			Affine3 lhs[2] = { a, b }, rhs[2] = { b, a };
+			Affine3::Multiply(lhs, rhs, lhs, 2);
+			Assert::AreEqual(a * b, lhs[0]);
+			Assert::AreEqual(b * a, lhs[1]);
+		}
+
+		TEST_METHOD(Inverse)
+		{
+			Matrix4 m = MakeTransform(2.0f);
+			Affine3 a = Affine3::MakeFromMatrix(m);
+			Affine3 inverse = a.Inverse();
+
+			Assert::AreEqual(m.InverseAffine(), inverse.ToMatrix4());
+			Assert::AreEqual(Affine3(), a * inverse);
+			Assert::AreEqual(Affine3(), inverse * a);
+
+			// singular
+			Affine3 flat = Affine3::MakeFromMatrix(Matrix4::MakeScale(1, 0, 1));
+			Affine3 zero(Vector4(0, 0, 0, 0), Vector4(0, 0, 0, 0), Vector4(0, 0, 0, 0));
+			Assert::AreEqual(zero, flat.Inverse());
+		}
+
+		TEST_METHOD(Transforms)
+		{
+			Matrix4 m = MakeTransform(-0.8f);
+			Affine3 a = Affine3::MakeFromMatrix(m);
+
+			const size_t COUNT = 7;
+			Vector3 in[COUNT], points[COUNT], directions[COUNT];
+			for (size_t i = 0; i < COUNT; ++i) {
+				float t = (float)i;
+				in[i] = Vector3(sinf(t), cosf(t * 0.5f), t - 3.0f);
+			}
+			a.TransformPoints(in, points, COUNT);
+			a.TransformDirections(in, directions, COUNT);
+
+			for (size_t i = 0; i < COUNT; ++i) {
+				Assert::AreEqual(TransformByMatrix(m, in[i], 1), a.TransformPoint(in[i]));
+				Assert::AreEqual(TransformByMatrix(m, in[i], 0), a.TransformDirection(in[i]));
+				Assert::AreEqual(a.TransformPoint(in[i]), points[i]);
+				Assert::AreEqual(a.TransformDirection(in[i]), directions[i]);
+			}
+
+			// in place
+			a.TransformPoints(in, COUNT);
+			Assert::AreEqual(points[COUNT - 1], in[COUNT - 1]);
+		}
+	};
+}
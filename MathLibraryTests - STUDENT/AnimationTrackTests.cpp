@@ -0,0 +1,180 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/AnimationTrack.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::KeyframeCursor;
+using ::MathClasses::Matrix4;
+using ::MathClasses::Quaternion;
+using ::MathClasses::RotationTrack;
+using ::MathClasses::TransformCursor;
+using ::MathClasses::TransformTrack;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector3Track;
+using ::MathClasses::Vector4;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(AnimationTrackTests)
+	{
+	public:
+		// keys at uneven times, so the search has something to do
+		static TransformTrack MakeTrack(float offset)
+		{
+			TransformTrack track;
+			float time = 0.0f;
+			for (int i = 0; i < 20; ++i) {
+				float t = (float)i + offset;
+				track.translation.AddKey(time, Vector3(t, -t * 0.5f, 2.0f));
+				track.rotation.AddKey(time, Quaternion::MakeEuler(t * 0.3f, t * -0.2f, t * 0.1f));
+				track.scale.AddKey(time, Vector3(1.0f + t * 0.1f, 1.0f, 2.0f));
+				time += 0.1f + (i % 3) * 0.05f;
+			}
+			return track;
+		}
+
+		TEST_METHOD(Vector3Interpolation)
+		{
+			Vector3Track track;
+			track.AddKey(0.0f, Vector3(0, 0, 0));
+			track.AddKey(1.0f, Vector3(2, 4, -2));
+			track.AddKey(3.0f, Vector3(2, 0, 0));
+			Assert::AreEqual((size_t)3, track.KeyCount());
+			Assert::AreEqual(3.0f, track.Duration());
+
+			Assert::AreEqual(Vector3(1, 2, -1), track.Sample(0.5f));
+			Assert::AreEqual(Vector3(2, 4, -2), track.Sample(1.0f));
+			Assert::AreEqual(Vector3(2, 2, -1), track.Sample(2.0f));
+
+			// held at the ends
+			Assert::AreEqual(Vector3(0, 0, 0), track.Sample(-1.0f));
+			Assert::AreEqual(Vector3(2, 0, 0), track.Sample(10.0f));
+
+			// one key is constant, none is zero
+			Vector3Track one;
+			one.AddKey(1.0f, Vector3(5, 6, 7));
+			Assert::AreEqual(Vector3(5, 6, 7), one.Sample(0.0f));
+			Assert::AreEqual(Vector3(5, 6, 7), one.Sample(2.0f));
+			Assert::AreEqual(Vector3(0, 0, 0), Vector3Track().Sample(1.0f));
+		}
+
+		TEST_METHOD(RotationInterpolation)
+		{
+			Quaternion a = Quaternion::MakeAxisAngle(Vector3(0, 0, 1), 0.2f);
+			Quaternion b = Quaternion::MakeAxisAngle(Vector3(0, 0, 1), 1.0f);
+			RotationTrack track;
+			track.AddKey(0.0f, a);
+			// stored the other way round, still has to go the short way
+			track.AddKey(2.0f, -b);
+
+			Quaternion half = track.Sample(1.0f);
+			Assert::AreEqual(1.0f, half.Magnitude(), 0.00001f);
+			Vector3 rotated = half.Rotate(Vector3(1, 0, 0));
+			Assert::AreEqual(Vector3(cosf(0.6f), sinf(0.6f), 0), rotated);
+
+			Assert::AreEqual(a, track.Sample(-1.0f));
+			Assert::AreEqual(Quaternion(), RotationTrack().Sample(1.0f));
+		}
+
+		TEST_METHOD(CursorMatchesSearch)
+		{
+			TransformTrack track = MakeTrack(0.0f);
+			std::vector<float> times = track.translation.times;
+
+			// forwards in small steps, big jumps, backwards, and off both ends
+			std::vector<float> samples;
+			for (float t = -0.1f; t < track.Duration() + 0.2f; t += 0.013f) {
+				samples.push_back(t);
+			}
+			samples.push_back(0.05f);
+			samples.push_back(2.1f);
+			samples.push_back(0.7f);
+			samples.push_back(times[5]);
+			samples.push_back(times[4]);
+			samples.push_back(times.back());
+			samples.push_back(0.0f);
+
+			KeyframeCursor cursor;
+			for (float t : samples) {
+				float f, expectedF;
+				size_t key = cursor.Locate(times, t, f);
+				KeyframeCursor fresh;
+				size_t expected = fresh.Locate(times, t, expectedF);
+				Assert::AreEqual(expected, key);
+				Assert::AreEqual(expectedF, f, 0.00001f);
+				Assert::IsTrue(f >= 0.0f && f <= 1.0f);
+				Assert::IsTrue(key + 1 < times.size());
+				if (t > times[0] && t < times.back()) {
+					Assert::IsTrue(times[key] <= t && t < times[key + 1]);
+				}
+			}
+
+			// a cursor left past the end of a shorter track
+			Vector3Track shorter;
+			shorter.AddKey(0.0f, Vector3(0, 0, 0));
+			shorter.AddKey(1.0f, Vector3(1, 0, 0));
+			cursor.key = 15;
+			Assert::AreEqual(Vector3(0.5f, 0, 0), shorter.Sample(0.5f, cursor));
+		}
+
+		TEST_METHOD(SampleMatrix)
+		{
+			TransformTrack track;
+			Quaternion r = Quaternion::MakeEuler(0.4f, -0.3f, 1.1f);
+			track.translation.AddKey(0.0f, Vector3(1, 2, 3));
+			track.rotation.AddKey(0.0f, r);
+
+			// no scale keys is a scale of 1
+			TransformCursor cursor;
+			Vector3 t, s;
+			Quaternion q;
+			track.Sample(0.5f, cursor, t, q, s);
+			Assert::AreEqual(Vector3(1, 1, 1), s);
+
+			track.scale.AddKey(0.0f, Vector3(2, 3, 4));
+			Matrix4 m = track.SampleMatrix(0.5f, cursor);
+
+			// scale, then rotate, then move
+			Vector4 p = m * Vector4(1, 1, 1, 1);
+			Vector3 expected = r.Rotate(Vector3(2, 3, 4)) + Vector3(1, 2, 3);
+			Assert::AreEqual(expected, Vector3(p.x, p.y, p.z));
+		}
+
+		TEST_METHOD(BatchSample)
+		{
+			const size_t COUNT = 33;
+			std::vector<TransformTrack> tracks;
+			for (size_t i = 0; i < COUNT; ++i) {
+				tracks.push_back(MakeTrack((float)i * 0.25f));
+			}
+
+			// a pose of every track, played forwards over a few frames
+			std::vector<TransformCursor> cursors(COUNT);
+			std::vector<Matrix4> pose(COUNT);
+			for (float time = 0.0f; time < 3.0f; time += 1.0f / 60.0f) {
+				TransformTrack::Sample(tracks.data(), time, cursors.data(), pose.data(), COUNT);
+				for (size_t i = 0; i < COUNT; i += 8) {
+					TransformCursor fresh;
+					Assert::AreEqual(tracks[i].SampleMatrix(time, fresh), pose[i]);
+				}
+			}
+
+			// one track, many instances at different times
+			std::vector<float> times(COUNT);
+			for (size_t i = 0; i < COUNT; ++i) {
+				times[i] = (float)i * 0.07f;
+			}
+			std::vector<TransformCursor> instanceCursors(COUNT);
+			std::vector<Matrix4> out(COUNT);
+			TransformTrack::Sample(tracks[3], times.data(), instanceCursors.data(), out.data(), COUNT);
+			for (size_t i = 0; i < COUNT; ++i) {
+				TransformCursor fresh;
+				Assert::AreEqual(tracks[3].SampleMatrix(times[i], fresh), out[i]);
+			}
+		}
+	};
+}
@@ -0,0 +1,279 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/BVH.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::AABB;
+using ::MathClasses::BVH;
+using ::MathClasses::Matrix4;
+using ::MathClasses::ThreadPool;
+using ::MathClasses::Vector3;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(BVHTests)
+	{
+	public:
+		// a jumbled up scene of boxes of different sizes
+		static std::vector<AABB> MakeBoxes(size_t count)
+		{
+			std::vector<AABB> boxes(count);
+			for (size_t i = 0; i < count; ++i) {
+				float t = (float)i;
+				Vector3 centre(sinf(t * 1.37f) * 10.0f, cosf(t * 0.71f) * 6.0f, sinf(t * 0.13f + 1.0f) * 8.0f);
+				Vector3 extents(0.5f + (i % 5) * 0.4f, 0.5f + (i % 3) * 0.7f, 0.5f + (i % 7) * 0.2f);
+				boxes[i] = AABB::MakeCentreExtents(centre, extents);
+			}
+			return boxes;
+		}
+
+		static std::vector<size_t> Sorted(std::vector<size_t> values)
+		{
+			std::sort(values.begin(), values.end());
+			return values;
+		}
+
+		static std::vector<size_t> RaycastAll(const BVH& bvh, const Vector3& origin, const Vector3& direction, float maxT)
+		{
+			std::vector<size_t> hits;
+			bvh.Raycast(origin, direction, maxT, [&hits](size_t i, float&) { hits.push_back(i); });
+			return Sorted(hits);
+		}
+
+		static std::vector<size_t> BruteRaycast(const std::vector<AABB>& boxes, const Vector3& origin, const Vector3& direction, float maxT)
+		{
+			Vector3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+			std::vector<size_t> hits;
+			float entry;
+			for (size_t i = 0; i < boxes.size(); ++i) {
+				if (BVH::RayHitsBox(boxes[i].min, boxes[i].max, origin, inverse, maxT, entry)) {
+					hits.push_back(i);
+				}
+			}
+			return hits;
+		}
+
+		static void CheckTree(const BVH& bvh, const std::vector<AABB>& boxes)
+		{
+			// every primitive in exactly one leaf, and every node inside its parent
+			std::vector<int> seen(boxes.size(), 0);
+			for (size_t n = 0; n < bvh.NodeCount(); ++n) {
+				const BVH::Node& node = bvh.GetNode(n);
+				if (node.IsLeaf()) {
+					for (size_t s = node.leftOrFirst; s < node.leftOrFirst + node.count; ++s) {
+						size_t prim = bvh.GetPrimitive(s);
+						++seen[prim];
+						Assert::IsTrue(node.Bounds().Contains(boxes[prim]));
+					}
+				}
+				else {
+					Assert::IsTrue(node.leftOrFirst > n);
+					Assert::IsTrue(node.Bounds().Contains(bvh.GetNode(node.leftOrFirst).Bounds()));
+					Assert::IsTrue(node.Bounds().Contains(bvh.GetNode(node.leftOrFirst + 1).Bounds()));
+				}
+			}
+			for (int count : seen) {
+				Assert::AreEqual(1, count);
+			}
+		}
+
+		TEST_METHOD(NodeLayout)
+		{
+			Assert::AreEqual((size_t)32, sizeof(BVH::Node));
+		}
+
+		TEST_METHOD(Empty)
+		{
+			BVH bvh;
+			bvh.Build(nullptr, 0);
+			Assert::AreEqual((size_t)0, bvh.NodeCount());
+			Assert::IsTrue(bvh.Bounds().IsEmpty());
+
+			bool called = false;
+			bvh.Raycast(Vector3(0, 0, 0), Vector3(1, 0, 0), 100.0f, [&called](size_t, float&) { called = true; });
+			bvh.Query(AABB(Vector3(-1, -1, -1), Vector3(1, 1, 1)), [&called](size_t) { called = true; });
+			Assert::IsFalse(called);
+		}
+
+		TEST_METHOD(BuildStructure)
+		{
+			std::vector<AABB> boxes = MakeBoxes(1000);
+			BVH bvh;
+			bvh.Build(boxes.data(), boxes.size());
+
+			CheckTree(bvh, boxes);
+			Assert::AreEqual(AABB::Merge(boxes.data(), boxes.size()), bvh.Bounds());
+			// a full binary tree, with at least one primitive per leaf
+			Assert::IsTrue(bvh.NodeCount() <= boxes.size() * 2 - 1);
+		}
+
+		TEST_METHOD(SameCentres)
+		{
+			// nothing to split on, but leaves still get limited
+			std::vector<AABB> boxes(50, AABB(Vector3(-1, -1, -1), Vector3(1, 1, 1)));
+			BVH bvh;
+			bvh.Build(boxes.data(), boxes.size(), 4);
+			CheckTree(bvh, boxes);
+			for (size_t n = 0; n < bvh.NodeCount(); ++n) {
+				Assert::IsTrue(bvh.GetNode(n).count <= 4);
+			}
+		}
+
+		TEST_METHOD(RaysMatchBruteForce)
+		{
+			std::vector<AABB> boxes = MakeBoxes(777);
+			boxes[3] = AABB();
+			BVH bvh;
+			bvh.Build(boxes.data(), boxes.size());
+
+			size_t total = 0;
+			for (int r = 0; r < 50; ++r) {
+				float t = (float)r;
+				Vector3 origin(sinf(t) * 80.0f, cosf(t * 1.3f) * 80.0f, sinf(t * 0.4f) * 80.0f);
+				Vector3 direction = Vector3(0, 0, 0) - origin + Vector3(sinf(t * 2.1f) * 20.0f, 0, 0);
+				// and some along the axes, with zeroes in the direction
+				if (r % 5 == 0) {
+					direction = Vector3(0, r % 2 ? 1.0f : -1.0f, 0);
+				}
+				float maxT = r % 3 == 0 ? 0.7f : 100.0f;
+
+				std::vector<size_t> expected = BruteRaycast(boxes, origin, direction, maxT);
+				Assert::IsTrue(expected == RaycastAll(bvh, origin, direction, maxT));
+				total += expected.size();
+			}
+			Assert::IsTrue(total > 100);
+		}
+
+		TEST_METHOD(ClosestHit)
+		{
+			std::vector<AABB> boxes = MakeBoxes(500);
+			BVH bvh;
+			bvh.Build(boxes.data(), boxes.size());
+
+			Vector3 origin(-100, 0.5f, 0.5f), direction(1, 0, 0);
+			Vector3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+			size_t closest = boxes.size(), calls = 0;
+			bvh.Raycast(origin, direction, 1000.0f, [&](size_t i, float& maxT) {
+				float entry;
+				BVH::RayHitsBox(boxes[i].min, boxes[i].max, origin, inverse, maxT, entry);
+				maxT = entry;
+				closest = i;
+				++calls;
+			});
+
+			std::vector<size_t> all = BruteRaycast(boxes, origin, direction, 1000.0f);
+			Assert::IsTrue(all.size() > 2);
+			float best = 1000.0f, entry;
+			size_t expected = boxes.size();
+			for (size_t i : all) {
+				BVH::RayHitsBox(boxes[i].min, boxes[i].max, origin, inverse, 1000.0f, entry);
+				if (entry < best) {
+					best = entry;
+					expected = i;
+				}
+			}
+			Assert::AreEqual(expected, closest);
+			// front to back, so it shouldn't have needed every hit
+			Assert::IsTrue(calls < all.size());
+		}
+
+		TEST_METHOD(TransformedRay)
+		{
+			std::vector<AABB> boxes = MakeBoxes(300);
+			BVH bvh;
+			bvh.Build(boxes.data(), boxes.size());
+
+			// a world ray, with the boxes living in a moved and turned local space
+			Matrix4 toLocal = Matrix4::MakeEuler(0.3f, 1.1f, -0.6f);
+			toLocal.axis[3] = ::MathClasses::Vector4(5, -2, 7, 1);
+			Vector3 origin(-60, 3, 10), direction(1, 0.1f, -0.2f);
+
+			::MathClasses::Vector4 o = toLocal * ::MathClasses::Vector4(origin.x, origin.y, origin.z, 1);
+			::MathClasses::Vector4 d = toLocal * ::MathClasses::Vector4(direction.x, direction.y, direction.z, 0);
+			std::vector<size_t> expected = RaycastAll(bvh, Vector3(o.x, o.y, o.z), Vector3(d.x, d.y, d.z), 200.0f);
+
+			std::vector<size_t> hits;
+			bvh.Raycast(toLocal, origin, direction, 200.0f, [&hits](size_t i, float&) { hits.push_back(i); });
+			Assert::IsTrue(!expected.empty());
+			Assert::IsTrue(expected == Sorted(hits));
+		}
+
+		TEST_METHOD(BoxAndSphereQueries)
+		{
+			std::vector<AABB> boxes = MakeBoxes(900);
+			BVH bvh;
+			bvh.Build(boxes.data(), boxes.size(), 2);
+
+			size_t total = 0;
+			for (int q = 0; q < 20; ++q) {
+				float t = (float)q;
+				Vector3 centre(sinf(t * 0.9f) * 12.0f, cosf(t * 1.7f) * 8.0f, sinf(t * 0.5f) * 10.0f);
+				AABB query = AABB::MakeCentreExtents(centre, Vector3(2, 3, 1));
+				float radius = 0.5f + q * 0.2f;
+
+				std::vector<size_t> expectedBoxes, expectedSpheres, hitBoxes, hitSpheres;
+				for (size_t i = 0; i < boxes.size(); ++i) {
+					if (query.Overlaps(boxes[i])) {
+						expectedBoxes.push_back(i);
+					}
+					Vector3 nearest(fmaxf(boxes[i].min.x, fminf(centre.x, boxes[i].max.x)),
+						fmaxf(boxes[i].min.y, fminf(centre.y, boxes[i].max.y)),
+						fmaxf(boxes[i].min.z, fminf(centre.z, boxes[i].max.z)));
+					if ((nearest - centre).Magnitude() <= radius) {
+						expectedSpheres.push_back(i);
+					}
+				}
+
+				bvh.Query(query, [&hitBoxes](size_t i) { hitBoxes.push_back(i); });
+				bvh.Query(centre, radius, [&hitSpheres](size_t i) { hitSpheres.push_back(i); });
+				Assert::IsTrue(expectedBoxes == Sorted(hitBoxes));
+				Assert::IsTrue(expectedSpheres == Sorted(hitSpheres));
+				total += expectedBoxes.size() + expectedSpheres.size();
+			}
+			Assert::IsTrue(total > 100);
+		}
+
+		TEST_METHOD(Refit)
+		{
+			std::vector<AABB> boxes = MakeBoxes(600);
+			BVH bvh;
+			bvh.Build(boxes.data(), boxes.size());
+
+			// move everything
+			for (size_t i = 0; i < boxes.size(); ++i) {
+				Vector3 offset(sinf(i * 0.1f) * 10.0f, 3.0f, -(float)(i % 4));
+				boxes[i] = AABB(boxes[i].min + offset, boxes[i].max + offset);
+			}
+			bvh.Refit(boxes.data());
+			CheckTree(bvh, boxes);
+			Assert::AreEqual(AABB::Merge(boxes.data(), boxes.size()), bvh.Bounds());
+
+			Vector3 origin(-90, 2, 1), direction(1, 0.05f, 0);
+			Assert::IsTrue(BruteRaycast(boxes, origin, direction, 200.0f) == RaycastAll(bvh, origin, direction, 200.0f));
+		}
+
+		TEST_METHOD(ParallelBuildMatchesSerial)
+		{
+			std::vector<AABB> boxes = MakeBoxes(20000);
+			BVH serial, parallel;
+			serial.Build(boxes.data(), boxes.size());
+
+			ThreadPool pool(3);
+			parallel.Build(boxes.data(), boxes.size(), pool);
+
+			CheckTree(parallel, boxes);
+			Assert::AreEqual(serial.NodeCount(), parallel.NodeCount());
+			Assert::AreEqual(serial.Bounds(), parallel.Bounds());
+
+			for (int r = 0; r < 10; ++r) {
+				Vector3 origin(-100, r * 3.0f - 15.0f, r * 2.0f - 10.0f), direction(1, 0, 0.1f);
+				Assert::IsTrue(RaycastAll(serial, origin, direction, 300.0f) == RaycastAll(parallel, origin, direction, 300.0f));
+			}
+		}
+	};
+}
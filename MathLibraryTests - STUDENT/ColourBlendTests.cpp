@@ -0,0 +1,144 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/ColourBlend.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::AlphaMode;
+using ::MathClasses::Colour;
+using ::MathClasses::ColourBlend;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(ColourBlendTests)
+	{
+	public:
+		// a count that isn't a multiple of any register width, so the scalar tail runs too
+		static const size_t COUNT = 37;
+
+		std::vector<Colour> MakeColours(unsigned int seed)
+		{
+			std::vector<Colour> colours(COUNT);
+			for (size_t i = 0; i < COUNT; ++i) {
+				seed = seed * 1664525u + 1013904223u;
+				colours[i].colour = seed;
+			}
+			// make sure the extremes are covered
+			colours[0] = Colour(255, 255, 255, 255);
+			colours[1] = Colour(0, 0, 0, 0);
+			return colours;
+		}
+
+		std::vector<Colour> MakePremultiplied(unsigned int seed)
+		{
+			std::vector<Colour> colours = MakeColours(seed);
+			ColourBlend::Premultiply(colours.data(), colours.size());
+			return colours;
+		}
+
+		// every pixel must match the one-at-a-time scalar reference
+		template <ColourBlend::Op O>
+		void CheckMatchesScalar(void (*blend)(const Colour*, Colour*, size_t, AlphaMode), AlphaMode mode)
+		{
+			std::vector<Colour> src = mode == AlphaMode::Premultiplied ? MakePremultiplied(1) : MakeColours(1);
+			std::vector<Colour> dst = mode == AlphaMode::Premultiplied ? MakePremultiplied(2) : MakeColours(2);
+			std::vector<Colour> actual = dst;
+			blend(src.data(), actual.data(), COUNT, mode);
+
+			for (size_t i = 0; i < COUNT; ++i) {
+				Colour expected = mode == AlphaMode::Premultiplied ?
+					ColourBlend::BlendScalar<O>(src[i], dst[i]) :
+					ColourBlend::UnpremultiplyScalar(ColourBlend::BlendScalar<O>(
+						ColourBlend::PremultiplyScalar(src[i]), ColourBlend::PremultiplyScalar(dst[i])));
+				Assert::AreEqual(expected, actual[i]);
+			}
+		}
+
+		TEST_METHOD(OverPremultiplied)
+		{
+			Colour src[2] = { Colour(128, 0, 0, 128), Colour(10, 20, 30, 255) };
+			Colour dst[2] = { Colour(0, 0, 255, 255), Colour(200, 200, 200, 255) };
+			ColourBlend::Over(src, dst, 2);
+
+			// half transparent red over blue
+			Assert::AreEqual(Colour(128, 0, 127, 255), dst[0]);
+			// opaque source replaces the destination
+			Assert::AreEqual(Colour(10, 20, 30, 255), dst[1]);
+		}
+
+		TEST_METHOD(OverStraight)
+		{
+			Colour src(255, 0, 0, 128);
+			Colour dst(0, 0, 255, 255);
+			ColourBlend::Over(&src, &dst, 1, AlphaMode::Straight);
+
+			Assert::AreEqual(Colour(128, 0, 127, 255), dst);
+		}
+
+		TEST_METHOD(AddClamps)
+		{
+			Colour src(200, 100, 0, 200);
+			Colour dst(100, 100, 0, 100);
+			ColourBlend::Add(&src, &dst, 1);
+
+			Assert::AreEqual(Colour(255, 200, 0, 255), dst);
+		}
+
+		TEST_METHOD(MultiplyOpaque)
+		{
+			Colour src(255, 128, 0, 255);
+			Colour dst(100, 200, 50, 255);
+			ColourBlend::Multiply(&src, &dst, 1);
+
+			Assert::AreEqual(Colour(100, 100, 0, 255), dst);
+		}
+
+		TEST_METHOD(ScreenOpaque)
+		{
+			Colour src(255, 128, 0, 255);
+			Colour dst(100, 200, 50, 255);
+			ColourBlend::Screen(&src, &dst, 1);
+
+			Assert::AreEqual(Colour(255, 228, 50, 255), dst);
+		}
+
+		TEST_METHOD(MatchesScalar)
+		{
+			for (AlphaMode mode : { AlphaMode::Premultiplied, AlphaMode::Straight }) {
+				CheckMatchesScalar<ColourBlend::Op::Over>(&ColourBlend::Over, mode);
+				CheckMatchesScalar<ColourBlend::Op::Add>(&ColourBlend::Add, mode);
+				CheckMatchesScalar<ColourBlend::Op::Multiply>(&ColourBlend::Multiply, mode);
+				CheckMatchesScalar<ColourBlend::Op::Screen>(&ColourBlend::Screen, mode);
+			}
+		}
+
+		TEST_METHOD(PremultiplyRoundTrip)
+		{
+			std::vector<Colour> original = MakeColours(3);
+			std::vector<Colour> colours = original;
+			ColourBlend::Premultiply(colours.data(), COUNT);
+
+			for (size_t i = 0; i < COUNT; ++i) {
+				Assert::AreEqual(ColourBlend::PremultiplyScalar(original[i]), colours[i]);
+			}
+
+			ColourBlend::Unpremultiply(colours.data(), COUNT);
+			for (size_t i = 0; i < COUNT; ++i) {
+				// precision is lost at low alpha, so only check the opaque-ish ones closely
+				unsigned int a = original[i].GetAlpha();
+				Assert::AreEqual(a, (unsigned int)colours[i].GetAlpha());
+				if (a == 0) {
+					Assert::AreEqual(Colour(0, 0, 0, 0), colours[i]);
+				}
+				else if (a >= 128) {
+					Assert::AreEqual((float)original[i].GetRed(), (float)colours[i].GetRed(), 1.0f);
+					Assert::AreEqual((float)original[i].GetGreen(), (float)colours[i].GetGreen(), 1.0f);
+					Assert::AreEqual((float)original[i].GetBlue(), (float)colours[i].GetBlue(), 1.0f);
+				}
+			}
+		}
+	};
+}
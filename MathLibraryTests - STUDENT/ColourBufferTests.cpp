@@ -0,0 +1,222 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/ColourBuffer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::AlphaMode;
+using ::MathClasses::Colour;
+using ::MathClasses::ColourBuffer;
+using ::MathClasses::ColourLayout;
+using ::MathClasses::ScaleFilter;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(ColourBufferTests)
+	{
+	public:
+		// a different colour for every pixel
+		static Colour Pattern(int x, int y)
+		{
+			return Colour((unsigned char)(x * 13), (unsigned char)(y * 7), (unsigned char)(x + y), 255);
+		}
+
+		static void FillPattern(ColourBuffer& buffer)
+		{
+			for (int y = 0; y < buffer.Height(); ++y) {
+				for (int x = 0; x < buffer.Width(); ++x) {
+					buffer.Set(x, y, Pattern(x, y));
+				}
+			}
+		}
+
+		TEST_METHOD(Constructor)
+		{
+			ColourBuffer linear(13, 5);
+			Assert::AreEqual(13, linear.Width());
+			Assert::AreEqual(5, linear.Height());
+			Assert::IsTrue(linear.Stride() >= 13);
+			Assert::AreEqual((size_t)0, reinterpret_cast<size_t>(linear.Data()) % 32);
+			Assert::AreEqual(Colour(0, 0, 0, 255), linear.Get(12, 4));
+
+			ColourBuffer tiled(13, 5, ColourLayout::Tiled);
+			Assert::AreEqual((size_t)(2 * 64), tiled.StorageSize());
+		}
+
+		TEST_METHOD(TiledIndex)
+		{
+			ColourBuffer tiled(20, 20, ColourLayout::Tiled);
+
+			// 8x8 blocks, row by row inside each block
+			Assert::AreEqual((size_t)0, tiled.Index(0, 0));
+			Assert::AreEqual((size_t)9, tiled.Index(1, 1));
+			Assert::AreEqual((size_t)64, tiled.Index(8, 0));
+			Assert::AreEqual((size_t)(3 * 64 + 2 * 8 + 1), tiled.Index(1, 10));
+
+			FillPattern(tiled);
+			for (int y = 0; y < 20; ++y) {
+				for (int x = 0; x < 20; ++x) {
+					Assert::AreEqual(Pattern(x, y), tiled.Get(x, y));
+				}
+			}
+		}
+
+		TEST_METHOD(FillRect)
+		{
+			for (ColourLayout layout : { ColourLayout::Linear, ColourLayout::Tiled }) {
+				ColourBuffer buffer(19, 11, layout);
+				buffer.Fill(Colour(1, 2, 3, 4));
+
+				// hangs off the right and bottom edges
+				Colour red(255, 0, 0, 255);
+				buffer.Fill(3, 2, 100, 100, red);
+
+				for (int y = 0; y < 11; ++y) {
+					for (int x = 0; x < 19; ++x) {
+						Colour expected = x >= 3 && y >= 2 ? red : Colour(1, 2, 3, 4);
+						Assert::AreEqual(expected, buffer.Get(x, y));
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(Blit)
+		{
+			for (ColourLayout srcLayout : { ColourLayout::Linear, ColourLayout::Tiled }) {
+				for (ColourLayout dstLayout : { ColourLayout::Linear, ColourLayout::Tiled }) {
+					ColourBuffer src(17, 9, srcLayout);
+					FillPattern(src);
+
+					ColourBuffer dst(12, 12, dstLayout);
+					dst.Fill(Colour());
+					// starts off the left edge, so the first two source columns are clipped
+					dst.Blit(src, 1, 2, 10, 5, -2, 3);
+
+					for (int y = 0; y < 12; ++y) {
+						for (int x = 0; x < 12; ++x) {
+							bool inside = x < 8 && y >= 3 && y < 8;
+							Colour expected = inside ? Pattern(x + 3, y - 1) : Colour();
+							Assert::AreEqual(expected, dst.Get(x, y));
+						}
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(AlphaBlit)
+		{
+			ColourBuffer src(3, 1, ColourLayout::Tiled);
+			src.Set(0, 0, Colour(128, 0, 0, 128));
+			src.Set(1, 0, Colour(0, 0, 0, 0));
+			src.Set(2, 0, Colour(10, 20, 30, 255));
+
+			ColourBuffer dst(4, 1);
+			dst.Fill(Colour(0, 0, 255, 255));
+			dst.AlphaBlit(src, 1, 0);
+
+			Assert::AreEqual(Colour(0, 0, 255, 255), dst.Get(0, 0));
+			Assert::AreEqual(Colour(128, 0, 127, 255), dst.Get(1, 0));
+			Assert::AreEqual(Colour(0, 0, 255, 255), dst.Get(2, 0));
+			Assert::AreEqual(Colour(10, 20, 30, 255), dst.Get(3, 0));
+		}
+
+		TEST_METHOD(ScaledCopyNearest)
+		{
+			ColourBuffer src(3, 2);
+			FillPattern(src);
+
+			ColourBuffer dst(6, 4, ColourLayout::Tiled);
+			dst.ScaledCopy(src, ScaleFilter::Nearest);
+
+			for (int y = 0; y < 4; ++y) {
+				for (int x = 0; x < 6; ++x) {
+					Assert::AreEqual(Pattern(x / 2, y / 2), dst.Get(x, y));
+				}
+			}
+
+			// and back down again
+			ColourBuffer back(3, 2);
+			back.ScaledCopy(dst, ScaleFilter::Nearest);
+			for (int y = 0; y < 2; ++y) {
+				for (int x = 0; x < 3; ++x) {
+					Assert::AreEqual(Pattern(x, y), back.Get(x, y));
+				}
+			}
+		}
+
+		TEST_METHOD(ScaledCopyBilinear)
+		{
+			ColourBuffer src(2, 1);
+			src.Set(0, 0, Colour(0, 100, 200, 255));
+			src.Set(1, 0, Colour(200, 100, 0, 255));
+
+			ColourBuffer dst(4, 2);
+			dst.ScaledCopy(src);
+
+			// the outer pixels clamp to the edge, the inner ones are 1/4 and 3/4 of the way across
+			for (int y = 0; y < 2; ++y) {
+				Assert::AreEqual(Colour(0, 100, 200, 255), dst.Get(0, y));
+				Assert::AreEqual(Colour(50, 100, 150, 255), dst.Get(1, y));
+				Assert::AreEqual(Colour(150, 100, 50, 255), dst.Get(2, y));
+				Assert::AreEqual(Colour(200, 100, 0, 255), dst.Get(3, y));
+			}
+		}
+
+		// One pixel of a bilinear ScaledCopy worked out on its own with Get
+		static Colour ReferenceBilinear(const ColourBuffer& src, int x, int y, int width, int height)
+		{
+			int x0, x1, fx, y0, y1, fy;
+			ReferenceTaps(x, src.Width(), width, x0, x1, fx);
+			ReferenceTaps(y, src.Height(), height, y0, y1, fy);
+			return ColourBuffer::Bilinear(src.Get(x0, y0), src.Get(x1, y0), src.Get(x0, y1), src.Get(x1, y1), fx, fy);
+		}
+
+		static void ReferenceTaps(int i, int srcSize, int dstSize, int& first, int& second, int& weight)
+		{
+			long long pos = ((2 * (long long)i + 1) * srcSize << 16) / (2 * (long long)dstSize) - (1 << 15);
+			pos = pos < 0 ? 0 : pos;
+			first = (int)(pos >> 16);
+			second = first + 1 < srcSize ? first + 1 : first;
+			weight = (int)((pos >> 8) & 0xff);
+		}
+
+		TEST_METHOD(ScaledCopyMatchesPerPixel)
+		{
+			// odd sizes so rows end part way through a vector and a tile, scaling up and down
+			const int sizes[][4] = { { 13, 9, 37, 21 }, { 37, 21, 13, 9 }, { 5, 17, 19, 3 } };
+			const ColourLayout layouts[] = { ColourLayout::Linear, ColourLayout::Tiled };
+
+			for (const int* size : sizes) {
+				for (ColourLayout srcLayout : layouts) {
+					ColourBuffer src(size[0], size[1], srcLayout);
+					FillPattern(src);
+
+					for (ColourLayout dstLayout : layouts) {
+						ColourBuffer bilinear(size[2], size[3], dstLayout), nearest(size[2], size[3], dstLayout);
+						bilinear.ScaledCopy(src);
+						nearest.ScaledCopy(src, ScaleFilter::Nearest);
+
+						for (int y = 0; y < size[3]; ++y) {
+							int sy = (2 * y + 1) * size[1] / (2 * size[3]);
+							for (int x = 0; x < size[2]; ++x) {
+								int sx = (2 * x + 1) * size[0] / (2 * size[2]);
+								Assert::AreEqual(src.Get(sx, sy), nearest.Get(x, y));
+								Assert::AreEqual(ReferenceBilinear(src, x, y, size[2], size[3]), bilinear.Get(x, y));
+							}
+						}
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(Bilinear)
+		{
+			Colour a(0, 64, 128, 255), b(255, 64, 0, 255), c(0, 0, 0, 0), d(255, 255, 255, 255);
+
+			Assert::AreEqual(a, ColourBuffer::Bilinear(a, b, c, d, 0, 0));
+			Assert::AreEqual(Colour(127, 64, 64, 255), ColourBuffer::Bilinear(a, b, c, d, 128, 0));
+			Assert::AreEqual(Colour(63, 63, 79, 159), ColourBuffer::Bilinear(a, b, c, d, 64, 128));
+		}
+	};
+}
@@ -0,0 +1,178 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/ColourSpace.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::Colour;
+using ::MathClasses::ColourSpace;
+using ::MathClasses::Vector4;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(ColourSpaceTests)
+	{
+	public:
+		static float ExactEncode(float c)
+		{
+			return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+		}
+
+		TEST_METHOD(ToLinearSingle)
+		{
+			Assert::AreEqual(0.0f, ColourSpace::ToLinear((unsigned char)0));
+			Assert::AreEqual(1.0f, ColourSpace::ToLinear((unsigned char)255), 0.000001f);
+			Assert::AreEqual(0.2158605f, ColourSpace::ToLinear((unsigned char)128), 0.000001f);
+			Assert::AreEqual(0.0030353f, ColourSpace::ToLinear((unsigned char)10), 0.000001f);
+		}
+
+		TEST_METHOD(FromLinearSingle)
+		{
+			Assert::AreEqual((unsigned char)0, ColourSpace::FromLinear(0.0f));
+			Assert::AreEqual((unsigned char)255, ColourSpace::FromLinear(1.0f));
+			Assert::AreEqual((unsigned char)188, ColourSpace::FromLinear(0.5f));
+
+			// clamped
+			Assert::AreEqual((unsigned char)0, ColourSpace::FromLinear(-3.0f));
+			Assert::AreEqual((unsigned char)255, ColourSpace::FromLinear(12.0f));
+		}
+
+		TEST_METHOD(NaNBecomesZero)
+		{
+			float nan = std::nanf("");
+			Assert::AreEqual((unsigned char)0, ColourSpace::FromLinear(nan));
+
+			// in every channel, through both the batch registers and the scalar tail
+			const size_t COUNT = 5;
+			float linear[COUNT * 4];
+			for (size_t i = 0; i < COUNT * 4; ++i) {
+				linear[i] = nan;
+			}
+			Colour out[COUNT];
+			ColourSpace::FromLinear(linear, out, COUNT);
+			for (size_t i = 0; i < COUNT; ++i) {
+				Assert::AreEqual(Colour(0, 0, 0, 0), out[i]);
+			}
+
+			// alpha from the hue conversions too
+			Assert::AreEqual((unsigned char)0, ColourSpace::FromHSV(Vector4(0, 1, 1, nan)).GetAlpha());
+			Assert::AreEqual((unsigned char)0, ColourSpace::FromHSL(Vector4(0, 1, 0.5f, nan)).GetAlpha());
+		}
+
+		TEST_METHOD(EncodeErrorBound)
+		{
+			for (int i = 0; i <= 10000; ++i) {
+				float c = i / 10000.0f;
+				Assert::AreEqual(ExactEncode(c) * 255.0f, (float)ColourSpace::FromLinear(c), 0.75f);
+			}
+		}
+
+		TEST_METHOD(RoundTripEveryByte)
+		{
+			std::vector<Colour> colours(256);
+			for (int i = 0; i < 256; ++i) {
+				colours[i] = Colour((unsigned char)i, (unsigned char)(255 - i), (unsigned char)(i * 7), (unsigned char)i);
+			}
+
+			std::vector<float> linear(colours.size() * 4);
+			ColourSpace::ToLinear(colours.data(), linear.data(), colours.size());
+
+			for (int i = 0; i < 256; ++i) {
+				Assert::AreEqual(ColourSpace::ToLinear((unsigned char)i), linear[i * 4 + 0]);
+				// alpha is only scaled
+				Assert::AreEqual(i / 255.0f, linear[i * 4 + 3], 0.000001f);
+			}
+
+			std::vector<Colour> back(colours.size());
+			ColourSpace::FromLinear(linear.data(), back.data(), back.size());
+			for (int i = 0; i < 256; ++i) {
+				Assert::AreEqual(colours[i], back[i]);
+			}
+		}
+
+		TEST_METHOD(FromLinearBatchMatchesSingle)
+		{
+			// odd count so the scalar tail runs too, with some out of range values
+			const size_t COUNT = 7;
+			float linear[COUNT * 4];
+			for (size_t i = 0; i < COUNT * 4; ++i) {
+				linear[i] = i * 0.061f - 0.2f;
+			}
+
+			Colour out[COUNT];
+			ColourSpace::FromLinear(linear, out, COUNT);
+
+			for (size_t i = 0; i < COUNT; ++i) {
+				Assert::AreEqual(ColourSpace::FromLinear(linear[i * 4 + 0]), out[i].GetRed());
+				Assert::AreEqual(ColourSpace::FromLinear(linear[i * 4 + 1]), out[i].GetGreen());
+				Assert::AreEqual(ColourSpace::FromLinear(linear[i * 4 + 2]), out[i].GetBlue());
+
+				float alpha = linear[i * 4 + 3] < 0 ? 0 : (linear[i * 4 + 3] > 1 ? 1 : linear[i * 4 + 3]);
+				Assert::AreEqual(alpha * 255.0f, (float)out[i].GetAlpha(), 0.5f);
+			}
+		}
+
+		TEST_METHOD(ToHSVSingle)
+		{
+			Assert::AreEqual(Vector4(0, 1, 1, 1), ColourSpace::ToHSV(Colour(255, 0, 0, 255)));
+			Assert::AreEqual(Vector4(120, 1, 1, 0), ColourSpace::ToHSV(Colour(0, 255, 0, 0)));
+			Assert::AreEqual(Vector4(180, 1, 0.8f, 1), ColourSpace::ToHSV(Colour(0, 204, 204, 255)));
+			Assert::AreEqual(Vector4(300, 0.6f, 1, 1), ColourSpace::ToHSV(Colour(255, 102, 255, 255)));
+
+			// greys have no hue or saturation
+			Assert::AreEqual(Vector4(0, 0, 0.2f, 1), ColourSpace::ToHSV(Colour(51, 51, 51, 255)));
+			Assert::AreEqual(Vector4(0, 0, 0, 1), ColourSpace::ToHSV(Colour(0, 0, 0, 255)));
+		}
+
+		TEST_METHOD(ToHSLSingle)
+		{
+			Assert::AreEqual(Vector4(0, 1, 0.5f, 1), ColourSpace::ToHSL(Colour(255, 0, 0, 255)));
+			Assert::AreEqual(Vector4(240, 1, 0.4f, 1), ColourSpace::ToHSL(Colour(0, 0, 204, 255)));
+			Assert::AreEqual(Vector4(60, 1, 0.9f, 1), ColourSpace::ToHSL(Colour(255, 255, 204, 255)));
+			Assert::AreEqual(Vector4(0, 0, 1, 1), ColourSpace::ToHSL(Colour(255, 255, 255, 255)));
+		}
+
+		TEST_METHOD(FromHueSingle)
+		{
+			Assert::AreEqual(Colour(0, 204, 204, 255), ColourSpace::FromHSV(Vector4(180, 1, 0.8f, 1)));
+			Assert::AreEqual(Colour(255, 255, 204, 255), ColourSpace::FromHSL(Vector4(60, 1, 0.9f, 1)));
+
+			// hue wraps, saturation and value clamp
+			Assert::AreEqual(Colour(255, 0, 0, 128), ColourSpace::FromHSV(Vector4(720, 3, 1, 0.5f)));
+			Assert::AreEqual(Colour(0, 0, 255, 255), ColourSpace::FromHSL(Vector4(-120, 1, 0.5f, 1)));
+		}
+
+		TEST_METHOD(HueRoundTrip)
+		{
+			// odd count so the last register is only partly full
+			std::vector<Colour> colours;
+			for (int r = 0; r < 256; r += 15) {
+				for (int g = 0; g < 256; g += 17) {
+					for (int b = 0; b < 256; b += 51) {
+						colours.push_back(Colour((unsigned char)r, (unsigned char)g, (unsigned char)b, (unsigned char)(r ^ g)));
+					}
+				}
+			}
+			colours.push_back(Colour(1, 2, 3, 4));
+
+			std::vector<Vector4> hsv(colours.size()), hsl(colours.size());
+			ColourSpace::ToHSV(colours.data(), hsv.data(), colours.size());
+			ColourSpace::ToHSL(colours.data(), hsl.data(), colours.size());
+
+			std::vector<Colour> fromHsv(colours.size()), fromHsl(colours.size());
+			ColourSpace::FromHSV(hsv.data(), fromHsv.data(), colours.size());
+			ColourSpace::FromHSL(hsl.data(), fromHsl.data(), colours.size());
+
+			for (size_t i = 0; i < colours.size(); ++i) {
+				Assert::AreEqual(ColourSpace::ToHSV(colours[i]), hsv[i]);
+				Assert::AreEqual(ColourSpace::ToHSL(colours[i]), hsl[i]);
+				Assert::AreEqual(colours[i], fromHsv[i]);
+				Assert::AreEqual(colours[i], fromHsl[i]);
+			}
+		}
+	};
+}
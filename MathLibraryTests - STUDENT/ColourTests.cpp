@@ -5,6 +5,8 @@
 #include "MathHeaders/Colour.h"
 #include <UnitTestLib.h>
 
+#include <cmath>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using ::MathClasses::Colour;
 using ::UnitLib::Byte;
@@ -95,5 +97,15 @@ namespace MathLibraryTests
 			auto alpha = actual.GetAlpha();
 			Assert::AreEqual(alpha, (Byte)255);
 		}
+		// float channel to byte
+		TEST_METHOD(FloatToByte)
+		{
+			Assert::AreEqual((Byte)0, Colour::FloatToByte(0.0f));
+			Assert::AreEqual((Byte)255, Colour::FloatToByte(1.0f));
+			Assert::AreEqual((Byte)128, Colour::FloatToByte(0.5f));
+			Assert::AreEqual((Byte)0, Colour::FloatToByte(-2.0f));
+			Assert::AreEqual((Byte)255, Colour::FloatToByte(7.0f));
+			Assert::AreEqual((Byte)0, Colour::FloatToByte(std::nanf("")));
+		}
 	};
 }
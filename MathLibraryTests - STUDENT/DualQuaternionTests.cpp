@@ -0,0 +1,135 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/DualQuaternion.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::DualQuaternion;
+using ::MathClasses::Matrix4;
+using ::MathClasses::Quaternion;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector4;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(DualQuaternionTests)
+	{
+	public:
+		static Vector3 TransformByMatrix(const Matrix4& m, const Vector3& p)
+		{
+			Vector4 r = m * Vector4(p.x, p.y, p.z, 1);
+			return Vector3(r.x, r.y, r.z);
+		}
+
+		TEST_METHOD(DefaultIsIdentity)
+		{
+			DualQuaternion dq;
+			Assert::AreEqual(Quaternion(0, 0, 0, 1), dq.real);
+			Assert::AreEqual(Quaternion(0, 0, 0, 0), dq.dual);
+			Assert::AreEqual(Vector3(1, 2, 3), dq.TransformPoint(Vector3(1, 2, 3)));
+		}
+
+		TEST_METHOD(RotationTranslation)
+		{
+			Quaternion r = Quaternion::MakeEuler(0.4f, -1.2f, 2.0f);
+			Vector3 t(3, -4, 5);
+			DualQuaternion dq = DualQuaternion::MakeRotationTranslation(r, t);
+
+			Assert::AreEqual(r, dq.GetRotation());
+			Assert::AreEqual(t, dq.GetTranslation());
+			Assert::AreEqual(r.Rotate(Vector3(1, 2, 3)) + t, dq.TransformPoint(Vector3(1, 2, 3)));
+			Assert::AreEqual(r.Rotate(Vector3(1, 2, 3)), dq.TransformVector(Vector3(1, 2, 3)));
+
+			Matrix4 m = r.ToMatrix4();
+			m.axis[3] = Vector4(t.x, t.y, t.z, 1);
+			Assert::AreEqual(m, dq.ToMatrix4());
+
+			Assert::AreEqual(Vector3(4, -2, 8), DualQuaternion::MakeTranslation(t).TransformPoint(Vector3(1, 2, 3)));
+		}
+
+		TEST_METHOD(Multiply)
+		{
+			DualQuaternion a = DualQuaternion::MakeRotationTranslation(Quaternion::MakeEuler(0.3f, 0.2f, 0.1f), Vector3(1, 0, 0));
+			DualQuaternion b = DualQuaternion::MakeRotationTranslation(Quaternion::MakeEuler(-1.0f, 0.5f, 0.0f), Vector3(0, 2, -1));
+
+			// b first, like the matrices
+			Vector3 p(0.5f, -1.5f, 2.0f);
+			Assert::AreEqual(a.TransformPoint(b.TransformPoint(p)), (a * b).TransformPoint(p));
+			Assert::AreEqual(a.ToMatrix4() * b.ToMatrix4(), (a * b).ToMatrix4());
+
+			// conjugate undoes it
+			DualQuaternion identity = a * a.Conjugate();
+			Assert::AreEqual(Quaternion(0, 0, 0, 1), identity.real);
+			Assert::AreEqual(Quaternion(0, 0, 0, 0), identity.dual);
+		}
+
+		TEST_METHOD(Normalise)
+		{
+			DualQuaternion dq = DualQuaternion::MakeRotationTranslation(Quaternion::MakeEuler(0.3f, 0.2f, 0.1f), Vector3(1, 2, 3));
+			DualQuaternion scaled = dq * 3.0f;
+			// plus a bit of dual along real, which shouldn't change anything
+			scaled.dual = scaled.dual + scaled.real * 0.25f;
+
+			DualQuaternion n = scaled.Normalised();
+			Assert::AreEqual(dq.real, n.real);
+			Assert::AreEqual(dq.dual, n.dual);
+			Assert::AreEqual(0.0f, n.real.Dot(n.dual), 0.00001f);
+
+			// zero is left alone
+			DualQuaternion zero(Quaternion(0, 0, 0, 0), Quaternion(0, 0, 0, 0));
+			Assert::AreEqual(Quaternion(0, 0, 0, 0), zero.Normalised().real);
+		}
+
+		TEST_METHOD(Blend)
+		{
+			Quaternion r = Quaternion::MakeAxisAngle(Vector3(0, 0, 1), 1.0f);
+			DualQuaternion palette[] = {
+				DualQuaternion::MakeTranslation(Vector3(2, 0, 0)),
+				DualQuaternion::MakeTranslation(Vector3(0, 4, 0)),
+				DualQuaternion::MakeRotationTranslation(r, Vector3(0, 0, 0)),
+			};
+
+			// halfway between two translations
+			uint16_t bones[] = { 0, 1 };
+			float weights[] = { 0.5f, 0.5f };
+			DualQuaternion half = DualQuaternion::Blend(palette, bones, weights, 2);
+			Assert::AreEqual(Vector3(1, 2, 0), half.GetTranslation());
+
+			// one bone on its own is just that bone, even stored flipped
+			palette[2] = palette[2] * -1.0f;
+			uint16_t one[] = { 2 };
+			float full[] = { 1.0f };
+			Assert::AreEqual(r.Rotate(Vector3(1, 0, 0)), DualQuaternion::Blend(palette, one, full, 1).TransformPoint(Vector3(1, 0, 0)));
+
+			// a flipped bone gets flipped back instead of cancelling out
+			DualQuaternion identity[] = { DualQuaternion(), DualQuaternion() * -1.0f };
+			DualQuaternion blended = DualQuaternion::Blend(identity, bones, weights, 2);
+			Assert::AreEqual(Quaternion(0, 0, 0, 1), blended.real);
+
+			// halfway round, rigidly - still unit length, unlike blended matrices
+			DualQuaternion turn[] = { DualQuaternion(), DualQuaternion::MakeRotationTranslation(Quaternion::MakeAxisAngle(Vector3(1, 0, 0), 3.0f), Vector3(0, 0, 0)) };
+			Vector3 p = DualQuaternion::Blend(turn, bones, weights, 2).TransformPoint(Vector3(0, 1, 0));
+			Assert::AreEqual(1.0f, p.Magnitude(), 0.00001f);
+		}
+
+		TEST_METHOD(BatchFunctions)
+		{
+			DualQuaternion in[3] = {
+				DualQuaternion::MakeRotationTranslation(Quaternion::MakeEuler(0.1f, 0.2f, 0.3f), Vector3(1, 2, 3)) * 2.0f,
+				DualQuaternion::MakeTranslation(Vector3(-1, 0, 0)),
+				DualQuaternion() * 0.5f,
+			};
+			DualQuaternion normalised[3];
+			Matrix4 matrices[3];
+			DualQuaternion::Normalise(in, normalised, 3);
+			DualQuaternion::ToMatrix4(normalised, matrices, 3);
+			for (int i = 0; i < 3; ++i) {
+				Assert::AreEqual(in[i].Normalised().real, normalised[i].real);
+				Assert::AreEqual(in[i].Normalised().dual, normalised[i].dual);
+				Assert::AreEqual(normalised[i].ToMatrix4(), matrices[i]);
+				Assert::AreEqual(normalised[i].TransformPoint(Vector3(1, 1, 1)), TransformByMatrix(matrices[i], Vector3(1, 1, 1)));
+			}
+		}
+	};
+}
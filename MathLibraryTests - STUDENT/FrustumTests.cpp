@@ -0,0 +1,154 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/Frustum.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::AABB;
+using ::MathClasses::ClipDepth;
+using ::MathClasses::Frustum;
+using ::MathClasses::Matrix4;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector3SoA;
+using ::MathClasses::Vector4;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(FrustumTests)
+	{
+	public:
+		// OpenGL style 90 degree perspective looking down -z, near 1, far 100
+		static Matrix4 MakePerspective(ClipDepth depth)
+		{
+			float n = 1.0f, f = 100.0f;
+			Matrix4 m;
+			m.mm[0][0] = 1.0f;
+			m.mm[1][1] = 1.0f;
+			m.mm[2][3] = -1.0f;
+			if (depth == ClipDepth::NegativeOneToOne) {
+				m.mm[2][2] = -(f + n) / (f - n);
+				m.mm[3][2] = -2.0f * f * n / (f - n);
+			}
+			else {
+				m.mm[2][2] = -f / (f - n);
+				m.mm[3][2] = -f * n / (f - n);
+			}
+			return m;
+		}
+
+		TEST_METHOD(IdentityIsClipCube)
+		{
+			Frustum f = Frustum::MakeFromMatrix(Matrix4::MakeIdentity());
+
+			Assert::AreEqual(Vector4(1, 0, 0, 1), f.planes[Frustum::LEFT_PLANE]);
+			Assert::AreEqual(Vector4(-1, 0, 0, 1), f.planes[Frustum::RIGHT_PLANE]);
+			Assert::AreEqual(Vector4(0, 1, 0, 1), f.planes[Frustum::BOTTOM_PLANE]);
+			Assert::AreEqual(Vector4(0, -1, 0, 1), f.planes[Frustum::TOP_PLANE]);
+			Assert::AreEqual(Vector4(0, 0, 1, 1), f.planes[Frustum::NEAR_PLANE]);
+			Assert::AreEqual(Vector4(0, 0, -1, 1), f.planes[Frustum::FAR_PLANE]);
+
+			f = Frustum::MakeFromMatrix(Matrix4::MakeIdentity(), ClipDepth::ZeroToOne);
+			Assert::AreEqual(Vector4(0, 0, 1, 0), f.planes[Frustum::NEAR_PLANE]);
+		}
+
+		TEST_METHOD(PerspectivePlanes)
+		{
+			for (ClipDepth depth : { ClipDepth::NegativeOneToOne, ClipDepth::ZeroToOne }) {
+				Frustum f = Frustum::MakeFromMatrix(MakePerspective(depth), depth);
+
+				// near and far planes are 1 and 100 units down -z
+				Vector4 nearPlane(0, 0, -1, -1), farPlane(0, 0, 1, 100);
+				for (int i = 0; i < 4; ++i) {
+					Assert::AreEqual(nearPlane[i], f.planes[Frustum::NEAR_PLANE][i], 0.0001f);
+					Assert::AreEqual(farPlane[i], f.planes[Frustum::FAR_PLANE][i], 0.001f);
+				}
+
+				// 90 degrees, so the sides are at 45
+				float h = sqrtf(0.5f);
+				Assert::AreEqual(Vector4(h, 0, -h, 0), f.planes[Frustum::LEFT_PLANE]);
+				Assert::AreEqual(Vector4(0, -h, -h, 0), f.planes[Frustum::TOP_PLANE]);
+			}
+		}
+
+		TEST_METHOD(Points)
+		{
+			Frustum f = Frustum::MakeFromMatrix(MakePerspective(ClipDepth::NegativeOneToOne));
+
+			Assert::IsTrue(f.Contains(Vector3(0, 0, -50)));
+			Assert::IsTrue(f.Contains(Vector3(49, -49, -50)));
+			Assert::IsFalse(f.Contains(Vector3(0, 0, -0.5f)));
+			Assert::IsFalse(f.Contains(Vector3(0, 0, -101)));
+			Assert::IsFalse(f.Contains(Vector3(51, 0, -50)));
+			Assert::IsFalse(f.Contains(Vector3(0, 0, 50)));
+		}
+
+		TEST_METHOD(SpheresAndBoxes)
+		{
+			Frustum f = Frustum::MakeFromMatrix(MakePerspective(ClipDepth::NegativeOneToOne));
+
+			Assert::IsTrue(f.IntersectsSphere(Vector4(0, 0, -50, 1)));
+			// centre behind the camera but reaching past the near plane
+			Assert::IsTrue(f.IntersectsSphere(Vector4(0, 0, 1, 2.5f)));
+			Assert::IsFalse(f.IntersectsSphere(Vector4(0, 0, 1, 1.5f)));
+			Assert::IsFalse(f.IntersectsSphere(Vector4(0, 0, -110, 5)));
+			Assert::IsFalse(f.IntersectsSphere(Vector4(0, 0, -50, -1)));
+
+			Assert::IsTrue(f.Intersects(AABB(Vector3(-1, -1, -11), Vector3(1, 1, -9))));
+			// straddling the right plane
+			Assert::IsTrue(f.Intersects(AABB(Vector3(9, -1, -11), Vector3(12, 1, -9))));
+			Assert::IsFalse(f.Intersects(AABB(Vector3(12, -1, -11), Vector3(14, 1, -9))));
+			Assert::IsFalse(f.Intersects(AABB(Vector3(-1, -1, 0), Vector3(1, 1, 5))));
+			// surrounding the whole frustum
+			Assert::IsTrue(f.Intersects(AABB(Vector3(-500, -500, -500), Vector3(500, 500, 500))));
+			Assert::IsFalse(f.Intersects(AABB()));
+		}
+
+		TEST_METHOD(BatchMatchesSingle)
+		{
+			Frustum f = Frustum::MakeFromMatrix(MakePerspective(ClipDepth::ZeroToOne), ClipDepth::ZeroToOne);
+
+			// enough for a few mask words and a partial last block
+			const size_t COUNT = 101;
+			std::vector<Vector4> spheres(COUNT);
+			std::vector<AABB> boxes(COUNT);
+			std::vector<float> radii(COUNT);
+			Vector3SoA centres(COUNT);
+			for (size_t i = 0; i < COUNT; ++i) {
+				float t = (float)i;
+				Vector3 c(sinf(t * 1.7f) * 60.0f, cosf(t * 0.9f) * 60.0f, -60.0f + sinf(t * 0.3f) * 70.0f);
+				float r = 1.0f + (i % 7) * 2.0f;
+				spheres[i] = Vector4(c.x, c.y, c.z, r);
+				radii[i] = r;
+				centres.Set(i, c);
+				boxes[i] = AABB::MakeCentreExtents(c, Vector3(r, r * 0.5f, r * 2.0f));
+			}
+			boxes[5] = AABB();
+
+			std::vector<uint32_t> sphereBits(Frustum::MaskWords(COUNT), 0xFFFFFFFF);
+			std::vector<uint32_t> soaBits(Frustum::MaskWords(COUNT), 0xFFFFFFFF);
+			std::vector<uint32_t> boxBits(Frustum::MaskWords(COUNT), 0xFFFFFFFF);
+			f.CullSpheres(spheres.data(), COUNT, sphereBits.data());
+			f.CullSpheres(centres, radii.data(), soaBits.data());
+			f.CullAABBs(boxes.data(), COUNT, boxBits.data());
+
+			size_t visible = 0, culled = 0;
+			for (size_t i = 0; i < COUNT; ++i) {
+				bool sphere = f.IntersectsSphere(spheres[i]);
+				Assert::AreEqual(sphere, Frustum::IsVisible(sphereBits.data(), i));
+				Assert::AreEqual(sphere, Frustum::IsVisible(soaBits.data(), i));
+				Assert::AreEqual(f.Intersects(boxes[i]), Frustum::IsVisible(boxBits.data(), i));
+				(sphere ? visible : culled)++;
+			}
+			// make sure the test covers both
+			Assert::IsTrue(visible > 10 && culled > 10);
+
+			// bits past the end are left clear
+			Assert::AreEqual(0u, sphereBits.back() >> (COUNT % 32));
+			Assert::AreEqual(0u, boxBits.back() >> (COUNT % 32));
+		}
+	};
+}
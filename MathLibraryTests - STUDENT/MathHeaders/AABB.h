@@ -0,0 +1,206 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <string>
+
+#include "Simd.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+
+namespace MathClasses
+{
+    //
+    // AXIS ALIGNED BOUNDING BOXES
+    //
+    // A box from min to max. The default box is empty (min = +infinity,
+    // max = -infinity), so merging anything into it gives that thing back,
+    // and it contains and overlaps nothing.
+    //
+    struct AABB
+    {
+        Vector3 min, max;
+
+        // Default constructor - empty
+        AABB() : min{ Infinity(), Infinity(), Infinity() }, max{ -Infinity(), -Infinity(), -Infinity() } {}
+
+        AABB(const Vector3& min, const Vector3& max) : min{ min }, max{ max } {}
+
+        static AABB MakeEmpty() {
+            return AABB();
+        }
+
+        static AABB MakeCentreExtents(const Vector3& centre, const Vector3& extents) {
+            return AABB(centre - extents, centre + extents);
+        }
+
+        // smallest box around count points
+        static AABB MakeFromPoints(const Vector3* points, size_t count) {
+            AABB box;
+            for (size_t i = 0; i < count; ++i) {
+                box.Expand(points[i]);
+            }
+            return box;
+        }
+
+        bool IsEmpty() const {
+            return min.x > max.x || min.y > max.y || min.z > max.z;
+        }
+
+        Vector3 Centre() const {
+            return (min + max) * 0.5f;
+        }
+
+        // half the size along each axis
+        Vector3 Extents() const {
+            return (max - min) * 0.5f;
+        }
+
+        Vector3 Size() const {
+            return max - min;
+        }
+
+        // 0 for empty boxes
+        float SurfaceArea() const {
+            if (IsEmpty()) {
+                return 0.0f;
+            }
+            Vector3 s = Size();
+            return 2.0f * (s.x * s.y + s.y * s.z + s.z * s.x);
+        }
+
+        // all empty boxes are equal
+        bool operator ==(const AABB& rhs) const {
+            if (IsEmpty() || rhs.IsEmpty()) {
+                return IsEmpty() && rhs.IsEmpty();
+            }
+            return min == rhs.min && max == rhs.max;
+        }
+
+        bool operator !=(const AABB& rhs) const {
+            return !(*this == rhs);
+        }
+
+        std::string ToString() const {
+            return min.ToString() + " - " + max.ToString();
+        }
+
+        //
+        // MERGING
+        //
+
+        // grow to include point
+        void Expand(const Vector3& point) {
+            min = Vector3(fminf(min.x, point.x), fminf(min.y, point.y), fminf(min.z, point.z));
+            max = Vector3(fmaxf(max.x, point.x), fmaxf(max.y, point.y), fmaxf(max.z, point.z));
+        }
+
+        // smallest box around both
+        AABB Merge(const AABB& other) const {
+            return AABB(Vector3(fminf(min.x, other.min.x), fminf(min.y, other.min.y), fminf(min.z, other.min.z)),
+                Vector3(fmaxf(max.x, other.max.x), fmaxf(max.y, other.max.y), fmaxf(max.z, other.max.z)));
+        }
+
+        // smallest box around count boxes
+        static AABB Merge(const AABB* boxes, size_t count) {
+            AABB box;
+            for (size_t i = 0; i < count; ++i) {
+                box = box.Merge(boxes[i]);
+            }
+            return box;
+        }
+
+        //
+        // TESTS
+        //
+        // Touching counts, so boxes that only share a face still overlap.
+        //
+
+        bool Contains(const Vector3& point) const {
+            return point.x >= min.x && point.x <= max.x &&
+                point.y >= min.y && point.y <= max.y &&
+                point.z >= min.z && point.z <= max.z;
+        }
+
+        // true if other is entirely inside this box
+        bool Contains(const AABB& other) const {
+            return !other.IsEmpty() &&
+                other.min.x >= min.x && other.max.x <= max.x &&
+                other.min.y >= min.y && other.max.y <= max.y &&
+                other.min.z >= min.z && other.max.z <= max.z;
+        }
+
+        bool Overlaps(const AABB& other) const {
+            return min.x <= other.max.x && max.x >= other.min.x &&
+                min.y <= other.max.y && max.y >= other.min.y &&
+                min.z <= other.max.z && max.z >= other.min.z;
+        }
+
+        //
+        // TRANSFORMING
+        //
+        // Rather than transforming all eight corners, the centre is transformed
+        // as a point and the extents by the absolute value of the rotation and
+        // scale part of the matrix. That gives the exact bounds of the
+        // transformed box for any affine matrix, without the eight point transforms.
+        //
+
+        AABB Transformed(const Matrix4& m) const {
+            if (IsEmpty()) {
+                return *this;
+            }
+            Vector3 centre = Centre(), extents = Extents();
+#if defined(MATHCLASSES_SSE)
+            __m128 signMask = _mm_set1_ps(-0.0f);
+            __m128 c = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(m.axis[0].simd, _mm_set1_ps(centre.x)),
+                _mm_mul_ps(m.axis[1].simd, _mm_set1_ps(centre.y))), _mm_add_ps(
+                _mm_mul_ps(m.axis[2].simd, _mm_set1_ps(centre.z)),
+                m.axis[3].simd));
+            __m128 e = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_andnot_ps(signMask, m.axis[0].simd), _mm_set1_ps(extents.x)),
+                _mm_mul_ps(_mm_andnot_ps(signMask, m.axis[1].simd), _mm_set1_ps(extents.y))),
+                _mm_mul_ps(_mm_andnot_ps(signMask, m.axis[2].simd), _mm_set1_ps(extents.z)));
+
+            alignas(16) float lo[4], hi[4];
+            _mm_store_ps(lo, _mm_sub_ps(c, e));
+            _mm_store_ps(hi, _mm_add_ps(c, e));
+            return AABB(Vector3(lo[0], lo[1], lo[2]), Vector3(hi[0], hi[1], hi[2]));
+#else
+            Vector3 c, e;
+            for (int row = 0; row < 3; ++row) {
+                c[row] = m.mm[0][row] * centre.x + m.mm[1][row] * centre.y + m.mm[2][row] * centre.z + m.mm[3][row];
+                e[row] = fabsf(m.mm[0][row]) * extents.x + fabsf(m.mm[1][row]) * extents.y + fabsf(m.mm[2][row]) * extents.z;
+            }
+            return AABB(c - e, c + e);
+#endif
+        }
+
+        // out[i] = in[i] transformed by matrices[i], in and out may be the same array
+        static void Transform(const AABB* in, const Matrix4* matrices, AABB* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = in[i].Transformed(matrices[i]);
+            }
+        }
+
+        // out[i] = in[i] transformed by m, in and out may be the same array
+        static void Transform(const AABB* in, const Matrix4& m, AABB* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = in[i].Transformed(m);
+            }
+        }
+
+        // results[i] = boxes[i] overlaps query
+        static void Overlaps(const AABB& query, const AABB* boxes, bool* results, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                results[i] = query.Overlaps(boxes[i]);
+            }
+        }
+
+    private:
+        static float Infinity() {
+            return std::numeric_limits<float>::infinity();
+        }
+    };
+}
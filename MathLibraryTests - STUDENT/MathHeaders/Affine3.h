@@ -0,0 +1,256 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+
+namespace MathClasses
+{
+    //
+    // AFFINE TRANSFORMS
+    //
+    // A Matrix4 without the bottom row, which is always 0, 0, 0, 1 for
+    // anything built from translation, rotation and scale. That's 48 bytes
+    // instead of 64, and multiplying two of them skips the work for the row
+    // that isn't stored.
+    //
+    // Unlike Matrix4 this is stored by rows, so each row is one aligned
+    // register: rows[i] is (x axis, y axis, z axis, translation) component i.
+    // Same conventions otherwise, so a * b applies b first, and converting
+    // to and from a Matrix4 with that bottom row loses nothing.
+    //
+    struct alignas(16) Affine3
+    {
+        union {
+            // as individual floats, row by row
+            float v[12];
+
+            // as Vector4's
+            Vector4 rows[3];
+        };
+
+        // Default constructor - identity
+        Affine3() {
+            rows[0] = Vector4(1, 0, 0, 0);
+            rows[1] = Vector4(0, 1, 0, 0);
+            rows[2] = Vector4(0, 0, 1, 0);
+        }
+
+        Affine3(const Vector4& row0, const Vector4& row1, const Vector4& row2) {
+            rows[0] = row0;
+            rows[1] = row1;
+            rows[2] = row2;
+        }
+
+        static Affine3 MakeIdentity() {
+            return Affine3();
+        }
+
+        // Drops the bottom row, which should be 0, 0, 0, 1
+        static Affine3 MakeFromMatrix(const Matrix4& m) {
+#ifdef MATHCLASSES_SSE
+            __m128 c0 = m.axis[0].simd, c1 = m.axis[1].simd, c2 = m.axis[2].simd, c3 = m.axis[3].simd;
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            return Affine3(Vector4(c0), Vector4(c1), Vector4(c2));
+#else
+            return Affine3(Vector4(m.m1, m.m5, m.m9, m.m13),
+                Vector4(m.m2, m.m6, m.m10, m.m14),
+                Vector4(m.m3, m.m7, m.m11, m.m15));
+#endif
+        }
+
+        Matrix4 ToMatrix4() const {
+            Matrix4 m;
+#ifdef MATHCLASSES_SSE
+            __m128 r0 = rows[0].simd, r1 = rows[1].simd, r2 = rows[2].simd, r3 = _mm_setr_ps(0, 0, 0, 1);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            m.axis[0].simd = r0;
+            m.axis[1].simd = r1;
+            m.axis[2].simd = r2;
+            m.axis[3].simd = r3;
+#else
+            for (int c = 0; c < 4; ++c) {
+                m.axis[c] = Vector4(rows[0][c], rows[1][c], rows[2][c], c == 3 ? 1.0f : 0.0f);
+            }
+#endif
+            return m;
+        }
+
+        // Batch versions
+        static void MakeFromMatrix(const Matrix4* in, Affine3* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = MakeFromMatrix(in[i]);
+            }
+        }
+
+        static void ToMatrix4(const Affine3* in, Matrix4* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = in[i].ToMatrix4();
+            }
+        }
+
+        Vector3 GetTranslation() const {
+            return Vector3(rows[0].w, rows[1].w, rows[2].w);
+        }
+
+        //
+        // Maths Operators
+
+        // operator * (Affine3, Affine3) - rhs is applied first
+        //
+        // Each row of the result is rhs's rows weighted by our row, plus our
+        // translation, which is what rhs's missing 0, 0, 0, 1 row would add.
+        Affine3 operator *(const Affine3& rhs) const {
+            Affine3 result;
+#ifdef MATHCLASSES_SSE
+            __m128 b0 = rhs.rows[0].simd, b1 = rhs.rows[1].simd, b2 = rhs.rows[2].simd;
+            __m128 wMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+            for (int i = 0; i < 3; ++i) {
+                __m128 a = rows[i].simd;
+                __m128 r = _mm_mul_ps(b0, _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)));
+                r = _mm_add_ps(r, _mm_mul_ps(b1, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1))));
+                r = _mm_add_ps(r, _mm_mul_ps(b2, _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2))));
+                result.rows[i].simd = _mm_add_ps(r, _mm_and_ps(a, wMask));
+            }
+#else
+            for (int i = 0; i < 3; ++i) {
+                const Vector4& a = rows[i];
+                result.rows[i] = rhs.rows[0] * a.x + rhs.rows[1] * a.y + rhs.rows[2] * a.z + Vector4(0, 0, 0, a.w);
+            }
+#endif
+            return result;
+        }
+
+        // operator *=
+        Affine3& operator *=(const Affine3& rhs) {
+            *this = *this * rhs;
+            return *this;
+        }
+
+        // Batch version, out[i] = lhs[i] * rhs[i]. out may be either input.
+        static void Multiply(const Affine3* lhs, const Affine3* rhs, Affine3* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = lhs[i] * rhs[i];
+            }
+        }
+
+        bool operator ==(const Affine3& rhs) const {
+            for (int i = 0; i < 12; i++) {
+                if (fabs(v[i] - rhs.v[i]) > 1e-6f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool operator !=(const Affine3& rhs) const {
+            return !(*this == rhs);
+        }
+
+        std::string ToString() const {
+            std::string str = std::to_string(v[0]);
+            for (size_t i = 1; i < 12; ++i) {
+                str += "," + std::to_string(v[i]);
+            }
+            return str;
+        }
+
+        //
+        // INVERSE
+        //
+
+        // Same approach as Matrix4::InverseAffine. A singular 3x3 part gives
+        // back all zeros.
+        Affine3 Inverse() const {
+            // rows with the translation taken out
+            Vector4 r0(rows[0].x, rows[0].y, rows[0].z, 0);
+            Vector4 r1(rows[1].x, rows[1].y, rows[1].z, 0);
+            Vector4 r2(rows[2].x, rows[2].y, rows[2].z, 0);
+
+            // columns of the inverse 3x3 part are the cross products of the rows
+            Vector4 c0 = r1.Cross(r2);
+            Vector4 c1 = r2.Cross(r0);
+            Vector4 c2 = r0.Cross(r1);
+
+            float det = r0.Dot(c0);
+            if (det == 0.0f) {
+                return Affine3(Vector4(0, 0, 0, 0), Vector4(0, 0, 0, 0), Vector4(0, 0, 0, 0));
+            }
+            float invDet = 1.0f / det;
+            c0 *= invDet;
+            c1 *= invDet;
+            c2 *= invDet;
+
+            // translation is -(A^-1 * t)
+            Vector3 t = GetTranslation();
+            Vector4 it = (c0 * t.x + c1 * t.y + c2 * t.z) * -1.0f;
+            return Affine3(Vector4(c0.x, c1.x, c2.x, it.x),
+                Vector4(c0.y, c1.y, c2.y, it.y),
+                Vector4(c0.z, c1.z, c2.z, it.z));
+        }
+
+        //
+        // TRANSFORMS
+        //
+
+        Vector3 TransformPoint(const Vector3& p) const {
+            return Vector3(rows[0].x * p.x + rows[0].y * p.y + rows[0].z * p.z + rows[0].w,
+                rows[1].x * p.x + rows[1].y * p.y + rows[1].z * p.z + rows[1].w,
+                rows[2].x * p.x + rows[2].y * p.y + rows[2].z * p.z + rows[2].w);
+        }
+
+        // Ignores the translation
+        Vector3 TransformDirection(const Vector3& d) const {
+            return Vector3(rows[0].x * d.x + rows[0].y * d.y + rows[0].z * d.z,
+                rows[1].x * d.x + rows[1].y * d.y + rows[1].z * d.z,
+                rows[2].x * d.x + rows[2].y * d.y + rows[2].z * d.z);
+        }
+
+        // Batch versions, the same rules as Matrix4::TransformPoints. The
+        // rows get turned into columns once up front, so each vector is
+        // three broadcasts and multiply-adds.
+        void TransformPoints(const Vector3* in, Vector3* out, size_t count) const {
+#ifdef MATHCLASSES_SSE
+            __m128 c0 = rows[0].simd, c1 = rows[1].simd, c2 = rows[2].simd, c3 = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            for (size_t i = 0; i < count; ++i) {
+                __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(in[i].x)), _mm_mul_ps(c1, _mm_set1_ps(in[i].y)));
+                r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
+                r = _mm_add_ps(r, c3);
+
+                _mm_storel_pi(reinterpret_cast<__m64*>(&out[i].x), r);
+                _mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
+            }
+#else
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = TransformPoint(in[i]);
+            }
+#endif
+        }
+
+        void TransformDirections(const Vector3* in, Vector3* out, size_t count) const {
+#ifdef MATHCLASSES_SSE
+            __m128 c0 = rows[0].simd, c1 = rows[1].simd, c2 = rows[2].simd, c3 = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            for (size_t i = 0; i < count; ++i) {
+                __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(in[i].x)), _mm_mul_ps(c1, _mm_set1_ps(in[i].y)));
+                r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
+
+                _mm_storel_pi(reinterpret_cast<__m64*>(&out[i].x), r);
+                _mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
+            }
+#else
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = TransformDirection(in[i]);
+            }
+#endif
+        }
+
+        // in-place versions
+        void TransformPoints(Vector3* points, size_t count) const { TransformPoints(points, points, count); }
+        void TransformDirections(Vector3* directions, size_t count) const { TransformDirections(directions, directions, count); }
+    };
+}
@@ -0,0 +1,207 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "Vector3.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "Vector3SoA.h"
+
+namespace MathClasses
+{
+    //
+    // KEYFRAME CURSOR
+    //
+    // Remembers which key a track was last sampled at. Playback mostly moves
+    // forwards a little at a time, so the next sample is nearly always
+    // between the same two keys or the next two, and finding it is a couple
+    // of comparisons. Anything else, like jumping or looping back, falls
+    // back to a binary search.
+    //
+    // Keep one cursor per track per playing instance.
+    //
+    struct KeyframeCursor
+    {
+        size_t key = 0;
+
+        // Find the keys either side of time in sorted times. Returns the
+        // first, and sets fraction to how far time is towards the next one.
+        // Times before the first key or after the last get clamped to them.
+        size_t Locate(const std::vector<float>& times, float time, float& fraction) {
+            size_t count = times.size();
+            if (count < 2 || time <= times[0]) {
+                key = 0;
+                fraction = 0.0f;
+                return key;
+            }
+            if (time >= times[count - 1]) {
+                key = count - 2;
+                fraction = 1.0f;
+                return key;
+            }
+
+            if (key + 1 >= count) {
+                key = 0;
+            }
+            if (times[key] <= time) {
+                if (time >= times[key + 1]) {
+                    // the next pair along, or search everything after it
+                    if (time < times[key + 2]) {
+                        ++key;
+                    }
+                    else {
+                        key = std::upper_bound(times.begin() + key + 2, times.end(), time) - times.begin() - 1;
+                    }
+                }
+            }
+            else {
+                key = std::upper_bound(times.begin(), times.begin() + key, time) - times.begin() - 1;
+            }
+
+            float span = times[key + 1] - times[key];
+            fraction = span > 0.0f ? (time - times[key]) / span : 0.0f;
+            return key;
+        }
+    };
+
+    //
+    // KEYFRAME TRACKS
+    //
+    // Key times and values stored as separate arrays. Keys must be added in
+    // time order. Sampling between keys is linear for Vector3's and the
+    // shorter way round for rotations, and holds the end keys outside the
+    // track. An empty track samples as value zero or no rotation.
+    //
+
+    struct Vector3Track
+    {
+        std::vector<float> times;
+        Vector3SoA values;
+
+        size_t KeyCount() const { return times.size(); }
+
+        // time of the last key, or 0 for an empty track
+        float Duration() const { return times.empty() ? 0.0f : times.back(); }
+
+        void AddKey(float time, const Vector3& value) {
+            times.push_back(time);
+            values.Resize(times.size());
+            values.Set(times.size() - 1, value);
+        }
+
+        Vector3 Sample(float time, KeyframeCursor& cursor) const {
+            if (times.empty()) {
+                return Vector3(0, 0, 0);
+            }
+            float f;
+            size_t a = cursor.Locate(times, time, f);
+            size_t b = a + 1 < times.size() ? a + 1 : a;
+            return Vector3(values.x[a] + (values.x[b] - values.x[a]) * f,
+                values.y[a] + (values.y[b] - values.y[a]) * f,
+                values.z[a] + (values.z[b] - values.z[a]) * f);
+        }
+
+        // without a cursor, binary searches every time
+        Vector3 Sample(float time) const {
+            KeyframeCursor cursor;
+            return Sample(time, cursor);
+        }
+    };
+
+    struct RotationTrack
+    {
+        std::vector<float> times;
+        std::vector<float> x, y, z, w;
+
+        size_t KeyCount() const { return times.size(); }
+
+        float Duration() const { return times.empty() ? 0.0f : times.back(); }
+
+        void AddKey(float time, const Quaternion& value) {
+            times.push_back(time);
+            x.push_back(value.x);
+            y.push_back(value.y);
+            z.push_back(value.z);
+            w.push_back(value.w);
+        }
+
+        // Normalised lerp, close enough to a slerp for keys a frame or so apart
+        Quaternion Sample(float time, KeyframeCursor& cursor) const {
+            if (times.empty()) {
+                return Quaternion();
+            }
+            float f;
+            size_t a = cursor.Locate(times, time, f);
+            size_t b = a + 1 < times.size() ? a + 1 : a;
+
+            // flip the second key if it's on the far side, so this goes the short way
+            float fa = 1.0f - f;
+            float fb = x[a] * x[b] + y[a] * y[b] + z[a] * z[b] + w[a] * w[b] < 0.0f ? -f : f;
+            return Quaternion(x[a] * fa + x[b] * fb, y[a] * fa + y[b] * fb, z[a] * fa + z[b] * fb, w[a] * fa + w[b] * fb).Normalised();
+        }
+
+        Quaternion Sample(float time) const {
+            KeyframeCursor cursor;
+            return Sample(time, cursor);
+        }
+    };
+
+    // One cursor for each of a TransformTrack's tracks
+    struct TransformCursor
+    {
+        KeyframeCursor translation, rotation, scale;
+    };
+
+    //
+    // TRANSFORM TRACKS
+    //
+    // Translation, rotation and scale tracks for one node or bone, each with
+    // its own keys. An empty scale track means a scale of 1.
+    //
+    struct TransformTrack
+    {
+        Vector3Track translation;
+        RotationTrack rotation;
+        Vector3Track scale;
+
+        // the longest of the three tracks
+        float Duration() const {
+            return std::max(translation.Duration(), std::max(rotation.Duration(), scale.Duration()));
+        }
+
+        void Sample(float time, TransformCursor& cursor, Vector3& outTranslation, Quaternion& outRotation, Vector3& outScale) const {
+            outTranslation = translation.Sample(time, cursor.translation);
+            outRotation = rotation.Sample(time, cursor.rotation);
+            outScale = scale.KeyCount() == 0 ? Vector3(1, 1, 1) : scale.Sample(time, cursor.scale);
+        }
+
+        // translation * rotation * scale
+        Matrix4 SampleMatrix(float time, TransformCursor& cursor) const {
+            Vector3 t, s;
+            Quaternion r;
+            Sample(time, cursor, t, r, s);
+
+            return Matrix4::MakeTRS(t, r, s);
+        }
+
+        //
+        // BATCH SAMPLING
+        //
+
+        // A whole pose: every track at the same time, like all the bones of
+        // a skeleton. cursors and out hold count entries.
+        static void Sample(const TransformTrack* tracks, float time, TransformCursor* cursors, Matrix4* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = tracks[i].SampleMatrix(time, cursors[i]);
+            }
+        }
+
+        // One track played by many instances, each at its own time
+        static void Sample(const TransformTrack& track, const float* times, TransformCursor* cursors, Matrix4* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = track.SampleMatrix(times[i], cursors[i]);
+            }
+        }
+    };
+}
@@ -0,0 +1,475 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "Simd.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+#include "AABB.h"
+#include "ThreadPool.h"
+
+namespace MathClasses
+{
+    //
+    // BOUNDING VOLUME HIERARCHY
+    //
+    // A binary tree of AABB's over an array of boxes, for finding what a ray,
+    // box or sphere touches without testing everything. Built top down, each
+    // node split where the surface area heuristic (SAH) says traversal will be
+    // cheapest, trying BIN_COUNT evenly spaced planes along each axis.
+    //
+    // Queries report primitives by their index in the array Build() was given.
+    // The boxes are copied, so the array doesn't need to outlive the build.
+    // Refit() updates the tree for boxes that have moved without rebuilding
+    // it, which is quick but lets the tree get looser the further things move.
+    //
+    struct BVH
+    {
+        // 32 bytes, two to a cache line. Children are always allocated as a
+        // pair, so an internal node only needs the index of the left one.
+        struct Node
+        {
+            Vector3 min;
+            // internal: left child index, right is left + 1. leaf: first slot in the leaf arrays
+            uint32_t leftOrFirst;
+            Vector3 max;
+            // number of primitives, 0 for internal nodes
+            uint32_t count;
+
+            bool IsLeaf() const { return count > 0; }
+            AABB Bounds() const { return AABB(min, max); }
+        };
+
+        static constexpr size_t BIN_COUNT = 16;
+        // leaves get forced past this, which bounds the traversal stacks
+        static constexpr size_t MAX_DEPTH = 64;
+
+        void Build(const AABB* boxes, size_t count, size_t maxLeafSize = 4) {
+            BeginBuild(boxes, count, maxLeafSize);
+            if (count > 0) {
+                BuildRecursive(nodes, 0, 0, count, 0);
+            }
+            EndBuild();
+        }
+
+        // Splits the top of the tree on this thread, then builds the subtrees
+        // below across the pool. Gives the same tree as the serial build,
+        // though the nodes end up in a different order.
+        void Build(const AABB* boxes, size_t count, ThreadPool& pool, size_t maxLeafSize = 4) {
+            BeginBuild(boxes, count, maxLeafSize);
+            if (count == 0) {
+                EndBuild();
+                return;
+            }
+
+            // breadth first, so the subtrees come out roughly the same size
+            std::vector<BuildTask> queue{ BuildTask{ 0, 0, count, 0 } }, subtrees;
+            size_t target = pool.ThreadCount() * 4;
+            for (size_t head = 0; head < queue.size(); ++head) {
+                BuildTask task = queue[head];
+                size_t waiting = queue.size() - head - 1 + subtrees.size();
+                if (task.end - task.begin <= PARALLEL_MIN_SIZE || waiting + 1 >= target) {
+                    subtrees.push_back(task);
+                    continue;
+                }
+
+                size_t mid;
+                if (!BuildNode(nodes, task.node, task.begin, task.end, task.depth, mid)) {
+                    continue;
+                }
+                size_t left = nodes[task.node].leftOrFirst;
+                queue.push_back(BuildTask{ left, task.begin, mid, task.depth + 1 });
+                queue.push_back(BuildTask{ left + 1, mid, task.end, task.depth + 1 });
+            }
+
+            // each subtree builds into its own array, with its root at 0
+            std::vector<NodeArray> built(subtrees.size());
+            pool.ParallelFor(0, subtrees.size(), 1, [this, &subtrees, &built](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const BuildTask& task = subtrees[i];
+                    built[i].push_back(Node());
+                    BuildRecursive(built[i], 0, task.begin, task.end, task.depth);
+                }
+            });
+
+            // then gets appended, with its child indices moved along to match
+            for (size_t i = 0; i < subtrees.size(); ++i) {
+                uint32_t base = static_cast<uint32_t>(nodes.size()) - 1;
+                for (size_t n = 0; n < built[i].size(); ++n) {
+                    Node node = built[i][n];
+                    if (!node.IsLeaf()) {
+                        node.leftOrFirst += base;
+                    }
+                    if (n == 0) {
+                        nodes[subtrees[i].node] = node;
+                    }
+                    else {
+                        nodes.push_back(node);
+                    }
+                }
+            }
+            EndBuild();
+        }
+
+        // New boxes for the same primitives, in the same order as the build
+        void Refit(const AABB* boxes) {
+            for (size_t i = 0; i < indices.size(); ++i) {
+                leafBoxes[i] = boxes[indices[i]];
+            }
+            // children always come after their parent
+            for (size_t n = nodes.size(); n-- > 0;) {
+                Node& node = nodes[n];
+                AABB bounds;
+                if (node.IsLeaf()) {
+                    bounds = AABB::Merge(&leafBoxes[node.leftOrFirst], node.count);
+                }
+                else {
+                    bounds = nodes[node.leftOrFirst].Bounds().Merge(nodes[node.leftOrFirst + 1].Bounds());
+                }
+                node.min = bounds.min;
+                node.max = bounds.max;
+            }
+        }
+
+        // number of primitives
+        size_t Size() const { return indices.size(); }
+
+        size_t NodeCount() const { return nodes.size(); }
+
+        // the root is node 0
+        const Node& GetNode(size_t i) const { return nodes[i]; }
+
+        // primitive in slot i of the leaves
+        size_t GetPrimitive(size_t slot) const { return indices[slot]; }
+
+        // around everything, empty if there is nothing
+        AABB Bounds() const {
+            return nodes.empty() ? AABB() : nodes[0].Bounds();
+        }
+
+        //
+        // QUERIES
+        //
+        // The callbacks are called once for each primitive whose box is hit,
+        // in no particular order.
+        //
+
+        // Ray origin + t * direction for t in [0, maxT]. Calls callback(index, maxT)
+        // with maxT by reference: lower it to the distance of a hit to only
+        // look for nearer ones from then on. Nearer children are visited
+        // first, so closest hit searches get to skip most of the tree.
+        template <typename F>
+        void Raycast(const Vector3& origin, const Vector3& direction, float maxT, F&& callback) const {
+            if (nodes.empty()) {
+                return;
+            }
+            Vector3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+            uint32_t stack[MAX_DEPTH];
+            size_t top = 0;
+            stack[top++] = 0;
+            float entry;
+            while (top > 0) {
+                const Node& node = nodes[stack[--top]];
+                // maxT may have come down since this node was pushed
+                if (!RayHitsBox(node.min, node.max, origin, inverse, maxT, entry)) {
+                    continue;
+                }
+
+                if (node.IsLeaf()) {
+                    for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                        if (RayHitsBox(leafBoxes[i].min, leafBoxes[i].max, origin, inverse, maxT, entry)) {
+                            callback(static_cast<size_t>(indices[i]), maxT);
+                        }
+                    }
+                    continue;
+                }
+
+                uint32_t left = node.leftOrFirst, right = left + 1;
+                float leftEntry, rightEntry;
+                bool hitLeft = RayHitsBox(nodes[left].min, nodes[left].max, origin, inverse, maxT, leftEntry);
+                bool hitRight = RayHitsBox(nodes[right].min, nodes[right].max, origin, inverse, maxT, rightEntry);
+                if (hitLeft && hitRight) {
+                    // far one first, so the near one comes off the stack next
+                    bool leftNearer = leftEntry <= rightEntry;
+                    stack[top++] = leftNearer ? right : left;
+                    stack[top++] = leftNearer ? left : right;
+                }
+                else if (hitLeft) {
+                    stack[top++] = left;
+                }
+                else if (hitRight) {
+                    stack[top++] = right;
+                }
+            }
+        }
+
+        // Ray in some other space, with toLocal taking it into the space of
+        // the boxes. Distances are in multiples of direction, so they mean
+        // the same thing in both spaces.
+        template <typename F>
+        void Raycast(const Matrix4& toLocal, const Vector3& origin, const Vector3& direction, float maxT, F&& callback) const {
+            Vector4 localOrigin = toLocal * Vector4(origin.x, origin.y, origin.z, 1);
+            Vector4 localDirection = toLocal * Vector4(direction.x, direction.y, direction.z, 0);
+            Raycast(Vector3(localOrigin.x, localOrigin.y, localOrigin.z),
+                Vector3(localDirection.x, localDirection.y, localDirection.z), maxT, std::forward<F>(callback));
+        }
+
+        // callback(index) for every primitive whose box overlaps box
+        template <typename F>
+        void Query(const AABB& box, F&& callback) const {
+            Traverse([&box](const Vector3& min, const Vector3& max) {
+                return box.Overlaps(AABB(min, max));
+            }, std::forward<F>(callback));
+        }
+
+        // callback(index) for every primitive whose box is within radius of centre
+        template <typename F>
+        void Query(const Vector3& centre, float radius, F&& callback) const {
+            float radiusSquared = radius * radius;
+            if (radius < 0.0f) {
+                return;
+            }
+            Traverse([&centre, radiusSquared](const Vector3& min, const Vector3& max) {
+                return DistanceSquared(min, max, centre) <= radiusSquared;
+            }, std::forward<F>(callback));
+        }
+
+        // Slab test, giving the distance the ray enters the box at. Empty
+        // boxes are always missed.
+        static bool RayHitsBox(const Vector3& min, const Vector3& max, const Vector3& origin, const Vector3& inverseDirection,
+            float maxT, float& entry) {
+            float enter = 0.0f, exit = maxT;
+            for (int axis = 0; axis < 3; ++axis) {
+                float t1 = (min[axis] - origin[axis]) * inverseDirection[axis];
+                float t2 = (max[axis] - origin[axis]) * inverseDirection[axis];
+                if (inverseDirection[axis] < 0.0f) {
+                    std::swap(t1, t2);
+                }
+                // fmaxf / fminf skip the NaN from 0 * infinity, for rays that
+                // run exactly along a face
+                enter = fmaxf(enter, t1);
+                exit = fminf(exit, t2);
+            }
+            entry = enter;
+            return enter <= exit;
+        }
+
+    private:
+        typedef std::vector<Node, AlignedAllocator<Node, 32>> NodeArray;
+
+        struct BuildTask
+        {
+            size_t node, begin, end, depth;
+        };
+
+        // subtrees smaller than this aren't worth splitting up between threads
+        static constexpr size_t PARALLEL_MIN_SIZE = 1024;
+
+        NodeArray nodes;
+        // primitive index for each leaf slot
+        std::vector<uint32_t> indices;
+        // boxes in leaf slot order, so leaves read them in one run
+        std::vector<AABB> leafBoxes;
+
+        // only used while building
+        const AABB* source = nullptr;
+        std::vector<Vector3> centroids;
+        size_t leafSize = 4;
+
+        void BeginBuild(const AABB* boxes, size_t count, size_t maxLeafSize) {
+            source = boxes;
+            leafSize = maxLeafSize > 0 ? maxLeafSize : 1;
+
+            indices.resize(count);
+            std::iota(indices.begin(), indices.end(), 0u);
+            centroids.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                // empty boxes can go anywhere, they never get hit
+                centroids[i] = boxes[i].IsEmpty() ? Vector3(0, 0, 0) : boxes[i].Centre();
+            }
+
+            nodes.clear();
+            if (count > 0) {
+                nodes.reserve(count * 2);
+                nodes.push_back(Node());
+            }
+        }
+
+        void EndBuild() {
+            leafBoxes.resize(indices.size());
+            for (size_t i = 0; i < indices.size(); ++i) {
+                leafBoxes[i] = source[indices[i]];
+            }
+            source = nullptr;
+            centroids.clear();
+        }
+
+        void BuildRecursive(NodeArray& out, size_t node, size_t begin, size_t end, size_t depth) {
+            size_t mid;
+            if (BuildNode(out, node, begin, end, depth, mid)) {
+                size_t left = out[node].leftOrFirst;
+                BuildRecursive(out, left, begin, mid, depth + 1);
+                BuildRecursive(out, left + 1, mid, end, depth + 1);
+            }
+        }
+
+        // Fill in out[node] for [begin, end). Either makes it a leaf and returns
+        // false, or adds its two children, partitions the range and sets mid.
+        bool BuildNode(NodeArray& out, size_t node, size_t begin, size_t end, size_t depth, size_t& mid) {
+            AABB bounds;
+            for (size_t i = begin; i < end; ++i) {
+                bounds = bounds.Merge(source[indices[i]]);
+            }
+            out[node].min = bounds.min;
+            out[node].max = bounds.max;
+
+            if (!Split(begin, end, depth, bounds, mid)) {
+                out[node].leftOrFirst = static_cast<uint32_t>(begin);
+                out[node].count = static_cast<uint32_t>(end - begin);
+                return false;
+            }
+
+            size_t left = out.size();
+            out.push_back(Node());
+            out.push_back(Node());
+            out[node].leftOrFirst = static_cast<uint32_t>(left);
+            out[node].count = 0;
+            return true;
+        }
+
+        // Binned SAH. The cost of a split is one traversal step plus, for each
+        // side, its primitive count times its share of the parent's surface area.
+        bool Split(size_t begin, size_t end, size_t depth, const AABB& bounds, size_t& mid) {
+            size_t count = end - begin;
+            if (count <= 1 || depth + 1 >= MAX_DEPTH) {
+                return false;
+            }
+
+            AABB centreBounds;
+            for (size_t i = begin; i < end; ++i) {
+                centreBounds.Expand(centroids[indices[i]]);
+            }
+
+            float area = bounds.SurfaceArea();
+            float bestCost = std::numeric_limits<float>::infinity();
+            int bestAxis = -1;
+            size_t bestBin = 0;
+            for (int axis = 0; axis < 3; ++axis) {
+                float lowest = centreBounds.min[axis];
+                float extent = centreBounds.max[axis] - lowest;
+                if (!(extent > 0.0f)) {
+                    continue;
+                }
+                float scale = BIN_COUNT / extent;
+
+                AABB binBounds[BIN_COUNT];
+                size_t binCounts[BIN_COUNT] = {};
+                for (size_t i = begin; i < end; ++i) {
+                    size_t bin = BinIndex(centroids[indices[i]][axis], lowest, scale);
+                    binBounds[bin] = binBounds[bin].Merge(source[indices[i]]);
+                    ++binCounts[bin];
+                }
+
+                // sweep from the right, then from the left, for every plane between bins
+                float rightAreas[BIN_COUNT];
+                size_t rightCounts[BIN_COUNT];
+                AABB sweep;
+                size_t swept = 0;
+                for (size_t plane = BIN_COUNT - 1; plane > 0; --plane) {
+                    sweep = sweep.Merge(binBounds[plane]);
+                    swept += binCounts[plane];
+                    rightAreas[plane] = sweep.SurfaceArea();
+                    rightCounts[plane] = swept;
+                }
+                sweep = AABB();
+                swept = 0;
+                for (size_t plane = 1; plane < BIN_COUNT; ++plane) {
+                    sweep = sweep.Merge(binBounds[plane - 1]);
+                    swept += binCounts[plane - 1];
+                    if (swept == 0 || rightCounts[plane] == 0) {
+                        continue;
+                    }
+                    float cost = area + sweep.SurfaceArea() * swept + rightAreas[plane] * rightCounts[plane];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestBin = plane;
+                    }
+                }
+            }
+
+            if (bestAxis < 0) {
+                // every centre in the same place, so just halve the list
+                if (count <= leafSize) {
+                    return false;
+                }
+                mid = begin + count / 2;
+                return true;
+            }
+            if (count <= leafSize && bestCost >= area * count) {
+                return false;
+            }
+
+            float lowest = centreBounds.min[bestAxis];
+            float scale = BIN_COUNT / (centreBounds.max[bestAxis] - lowest);
+            uint32_t* split = std::partition(&indices[begin], &indices[0] + end, [&](uint32_t i) {
+                return BinIndex(centroids[i][bestAxis], lowest, scale) < bestBin;
+            });
+            mid = split - &indices[0];
+            return true;
+        }
+
+        static size_t BinIndex(float centre, float lowest, float scale) {
+            size_t bin = static_cast<size_t>((centre - lowest) * scale);
+            return bin < BIN_COUNT ? bin : BIN_COUNT - 1;
+        }
+
+        static float DistanceSquared(const Vector3& min, const Vector3& max, const Vector3& point) {
+            float total = 0.0f;
+            for (int axis = 0; axis < 3; ++axis) {
+                // nearest point in the box, infinitely far for empty boxes
+                float d = point[axis] - fmaxf(min[axis], fminf(point[axis], max[axis]));
+                total += d * d;
+            }
+            return total;
+        }
+
+        // Depth first walk into every node that hits() accepts
+        template <typename H, typename F>
+        void Traverse(H&& hits, F&& callback) const {
+            if (nodes.empty()) {
+                return;
+            }
+            uint32_t stack[MAX_DEPTH];
+            size_t top = 0;
+            stack[top++] = 0;
+            while (top > 0) {
+                const Node& node = nodes[stack[--top]];
+                if (!hits(node.min, node.max)) {
+                    continue;
+                }
+                if (node.IsLeaf()) {
+                    for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                        if (hits(leafBoxes[i].min, leafBoxes[i].max)) {
+                            callback(static_cast<size_t>(indices[i]));
+                        }
+                    }
+                }
+                else {
+                    stack[top++] = node.leftOrFirst;
+                    stack[top++] = node.leftOrFirst + 1;
+                }
+            }
+        }
+    };
+
+    static_assert(sizeof(BVH::Node) == 32, "BVH nodes should be 32 bytes");
+}
@@ -63,5 +63,21 @@ namespace MathClasses
 		Colour(unsigned char red, unsigned char green, unsigned char blue, unsigned char alpha) : colour((static_cast<unsigned int>(red) << 24) | (static_cast<unsigned int>(green) << 16) | (static_cast<unsigned int>(blue) << 8) |static_cast<unsigned int>(alpha)) {
             // initialize all colour components as per the parameters
         }
+
+        bool operator ==(const Colour& other) const {
+            return colour == other.colour;
+        }
+
+        bool operator !=(const Colour& other) const {
+            return colour != other.colour;
+        }
+
+        // A [0, 1] float channel to the nearest byte, clamped. Compared so
+        // that NaN fails and becomes 0 rather than reaching the cast.
+        static unsigned char FloatToByte(float c) {
+            c = c > 0.0f ? c : 0.0f;
+            c = c < 1.0f ? c : 1.0f;
+            return static_cast<unsigned char>(c * 255.0f + 0.5f);
+        }
     };
 }
\ No newline at end of file
@@ -0,0 +1,433 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Simd.h"
+#include "Colour.h"
+#include "ColourBlend.h"
+
+namespace MathClasses
+{
+    // How a ColourBuffer orders its pixels in memory
+    enum class ColourLayout
+    {
+        // row after row, each row padded out to Stride() pixels
+        Linear,
+        // 8x8 blocks of pixels stored one after another, each block row by row.
+        // Nearby pixels in both directions share cache lines, which suits
+        // rotated or scaled access better than plain rows.
+        Tiled
+    };
+
+    enum class ScaleFilter
+    {
+        Nearest,
+        Bilinear
+    };
+
+    //
+    // COLOUR BUFFER
+    //
+    // A 2D image of Colour's in 32-byte aligned storage. Rows (or tiles) are
+    // padded to whole registers so fills and copies never need to special case
+    // the last few pixels of a row. All of the drawing operations clip to both
+    // buffers, so rectangles hanging off the edge are fine.
+    //
+    struct ColourBuffer
+    {
+        static const int TILE_SIZE = 8;
+
+        typedef std::vector<Colour, AlignedAllocator<Colour, 32>> ColourArray;
+
+        // Default constructor - empty
+        ColourBuffer() : width{ 0 }, height{ 0 }, stride{ 0 }, layout{ ColourLayout::Linear } {}
+
+        // width x height pixels of Colour() (opaque black)
+        ColourBuffer(int width, int height, ColourLayout layout = ColourLayout::Linear) :
+            width{ 0 }, height{ 0 }, stride{ 0 }, layout{ layout } {
+            Resize(width, height);
+        }
+
+        int Width() const { return width; }
+        int Height() const { return height; }
+
+        // Pixels from the start of one row to the next. For tiled buffers this
+        // is the padded width, i.e. the number of pixels across a row of tiles.
+        int Stride() const { return stride; }
+
+        ColourLayout Layout() const { return layout; }
+
+        // The raw storage, laid out as described by Layout()
+        Colour* Data() { return pixels.data(); }
+        const Colour* Data() const { return pixels.data(); }
+        size_t StorageSize() const { return pixels.size(); }
+
+        // Resizing throws away the existing contents
+        void Resize(int newWidth, int newHeight) {
+            width = newWidth > 0 ? newWidth : 0;
+            height = newHeight > 0 ? newHeight : 0;
+            stride = (width + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+
+            size_t rows = layout == ColourLayout::Tiled ? (height + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE : height;
+            pixels.assign(static_cast<size_t>(stride) * rows, Colour());
+        }
+
+        // Where pixel (x, y) lives in Data()
+        size_t Index(int x, int y) const {
+            if (layout == ColourLayout::Linear) {
+                return static_cast<size_t>(y) * stride + x;
+            }
+            size_t tile = static_cast<size_t>(y / TILE_SIZE) * (stride / TILE_SIZE) + x / TILE_SIZE;
+            return tile * TILE_SIZE * TILE_SIZE + (y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE;
+        }
+
+        Colour Get(int x, int y) const {
+            return pixels[Index(x, y)];
+        }
+
+        void Set(int x, int y, Colour colour) {
+            pixels[Index(x, y)] = colour;
+        }
+
+        //
+        // FILL
+        //
+
+        void Fill(Colour colour) {
+            FillSpan(pixels.data(), pixels.size(), colour);
+        }
+
+        void Fill(int x, int y, int w, int h, Colour colour) {
+            if (!ClipRect(x, y, w, h)) {
+                return;
+            }
+            for (int row = y; row < y + h; ++row) {
+                ForEachRun(x, row, w, [colour](Colour* run, int, int length) {
+                    FillSpan(run, length, colour);
+                });
+            }
+        }
+
+        //
+        // BLIT
+        //
+        // Copy a w x h rectangle from src at (srcX, srcY) to this buffer at
+        // (dstX, dstY). src and this may use different layouts but must not
+        // be the same buffer.
+        //
+
+        void Blit(const ColourBuffer& src, int srcX, int srcY, int w, int h, int dstX, int dstY) {
+            if (!ClipCopy(src, srcX, srcY, w, h, dstX, dstY)) {
+                return;
+            }
+            std::vector<Colour> rowBuffer;
+            for (int row = 0; row < h; ++row) {
+                const Colour* srcRow = src.ReadRow(srcX, srcY + row, w, rowBuffer);
+                ForEachRun(dstX, dstY + row, w, [srcRow](Colour* run, int offset, int length) {
+                    memcpy(run, srcRow + offset, length * sizeof(Colour));
+                });
+            }
+        }
+
+        // the whole of src with its top left corner at (dstX, dstY)
+        void Blit(const ColourBuffer& src, int dstX, int dstY) {
+            Blit(src, 0, 0, src.width, src.height, dstX, dstY);
+        }
+
+        // As Blit, but src is drawn over the existing pixels using ColourBlend::Over
+        void AlphaBlit(const ColourBuffer& src, int srcX, int srcY, int w, int h, int dstX, int dstY,
+            AlphaMode mode = AlphaMode::Premultiplied) {
+            if (!ClipCopy(src, srcX, srcY, w, h, dstX, dstY)) {
+                return;
+            }
+            std::vector<Colour> rowBuffer;
+            for (int row = 0; row < h; ++row) {
+                const Colour* srcRow = src.ReadRow(srcX, srcY + row, w, rowBuffer);
+                ForEachRun(dstX, dstY + row, w, [srcRow, mode](Colour* run, int offset, int length) {
+                    ColourBlend::Over(srcRow + offset, run, length, mode);
+                });
+            }
+        }
+
+        void AlphaBlit(const ColourBuffer& src, int dstX, int dstY, AlphaMode mode = AlphaMode::Premultiplied) {
+            AlphaBlit(src, 0, 0, src.width, src.height, dstX, dstY, mode);
+        }
+
+        //
+        // SCALED COPY
+        //
+        // Stretch the whole of src over the whole of this buffer. Source
+        // positions are sampled at pixel centres in 16.16 fixed point, and
+        // bilinear weights are 8-bit so every path gives identical results.
+        //
+        // The source columns and weights for each destination column are the
+        // same on every row, so they're worked out once up front. Each row
+        // then reads straight from the one or two source rows it needs, and
+        // writes straight into this buffer.
+        //
+
+        void ScaledCopy(const ColourBuffer& src, ScaleFilter filter = ScaleFilter::Bilinear) {
+            if (width == 0 || height == 0 || src.width == 0 || src.height == 0) {
+                return;
+            }
+
+            std::vector<Colour> scratch0, scratch1;
+            if (filter == ScaleFilter::Nearest) {
+                std::vector<int> columns(width);
+                for (int x = 0; x < width; ++x) {
+                    columns[x] = static_cast<int>(SampleCentre(x, src.width, width) >> 16);
+                }
+
+                int cachedY = -1;
+                const Colour* srcRow = nullptr;
+                for (int y = 0; y < height; ++y) {
+                    int sy = static_cast<int>(SampleCentre(y, src.height, height) >> 16);
+                    if (sy != cachedY) {
+                        srcRow = src.ReadRow(0, sy, src.width, scratch0);
+                        cachedY = sy;
+                    }
+                    ForEachRun(0, y, width, [srcRow, &columns](Colour* run, int offset, int length) {
+                        NearestRow(srcRow, &columns[offset], run, length);
+                    });
+                }
+                return;
+            }
+
+            // each weight repeated for the four channels, so two columns load as one register
+            std::vector<int> first(width), second(width);
+            std::vector<int16_t> weights(static_cast<size_t>(width) * 4);
+            for (int x = 0; x < width; ++x) {
+                int fx;
+                BilinearTaps(x, src.width, width, first[x], second[x], fx);
+                for (int c = 0; c < 4; ++c) {
+                    weights[x * 4 + c] = static_cast<int16_t>(fx);
+                }
+            }
+
+            int cachedY0 = -1, cachedY1 = -1;
+            const Colour* top = nullptr;
+            const Colour* bottom = nullptr;
+            for (int y = 0; y < height; ++y) {
+                int y0, y1, fy;
+                BilinearTaps(y, src.height, height, y0, y1, fy);
+                if (y0 != cachedY0) {
+                    top = src.ReadRow(0, y0, src.width, scratch0);
+                    cachedY0 = y0;
+                }
+                if (y1 != cachedY1) {
+                    bottom = src.ReadRow(0, y1, src.width, scratch1);
+                    cachedY1 = y1;
+                }
+                ForEachRun(0, y, width, [&, top, bottom, fy](Colour* run, int offset, int length) {
+                    BilinearRow(top, bottom, &first[offset], &second[offset], &weights[offset * 4], fy, run, length);
+                });
+            }
+        }
+
+        // Interpolate between four pixels, fx and fy are weights towards the second pixel out of 256
+        static Colour Bilinear(Colour tl, Colour tr, Colour bl, Colour br, int fx, int fy) {
+#if defined(MATHCLASSES_SSE)
+            // both pairs of pixels widened to 16 bits, left pixel in the low half
+            __m128i pixels = _mm_set_epi32(static_cast<int>(br.colour), static_cast<int>(bl.colour),
+                static_cast<int>(tr.colour), static_cast<int>(tl.colour));
+            __m128i top = _mm_unpacklo_epi8(pixels, _mm_setzero_si128());
+            __m128i bottom = _mm_unpackhi_epi8(pixels, _mm_setzero_si128());
+
+            short x1 = static_cast<short>(fx), x0 = static_cast<short>(256 - fx);
+            short y1 = static_cast<short>(fy), y0 = static_cast<short>(256 - fy);
+            __m128i wx = _mm_set_epi16(x1, x1, x1, x1, x0, x0, x0, x0);
+            __m128i wy = _mm_set_epi16(y1, y1, y1, y1, y0, y0, y0, y0);
+
+            top = LerpHalves(top, wx);
+            bottom = LerpHalves(bottom, wx);
+            __m128i result = LerpHalves(_mm_unpacklo_epi64(top, bottom), wy);
+
+            Colour out;
+            out.colour = static_cast<unsigned int>(_mm_cvtsi128_si32(_mm_packus_epi16(result, result)));
+            return out;
+#else
+            Colour out;
+            out.colour = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                unsigned int top = Lerp((tl.colour >> shift) & 0xff, (tr.colour >> shift) & 0xff, fx);
+                unsigned int bottom = Lerp((bl.colour >> shift) & 0xff, (br.colour >> shift) & 0xff, fx);
+                out.colour |= Lerp(top, bottom, fy) << shift;
+            }
+            return out;
+#endif
+        }
+
+    private:
+        int width, height, stride;
+        ColourLayout layout;
+        ColourArray pixels;
+
+        // Calls f(pointer, offset, length) for each contiguous piece of the
+        // row segment (x, y) to (x + w, y). offset counts from x.
+        template <typename F>
+        void ForEachRun(int x, int y, int w, F f) {
+            if (layout == ColourLayout::Linear) {
+                f(&pixels[Index(x, y)], 0, w);
+                return;
+            }
+            int offset = 0;
+            while (offset < w) {
+                int px = x + offset;
+                int length = TILE_SIZE - px % TILE_SIZE;
+                if (length > w - offset) {
+                    length = w - offset;
+                }
+                f(&pixels[Index(px, y)], offset, length);
+                offset += length;
+            }
+        }
+
+        // Pointer to w contiguous pixels of row y starting at x, copied into
+        // scratch first when the layout doesn't already store them that way
+        const Colour* ReadRow(int x, int y, int w, std::vector<Colour>& scratch) const {
+            if (layout == ColourLayout::Linear) {
+                return &pixels[Index(x, y)];
+            }
+            scratch.resize(w);
+            for (int offset = 0; offset < w;) {
+                int px = x + offset;
+                int length = TILE_SIZE - px % TILE_SIZE;
+                if (length > w - offset) {
+                    length = w - offset;
+                }
+                memcpy(&scratch[offset], &pixels[Index(px, y)], length * sizeof(Colour));
+                offset += length;
+            }
+            return scratch.data();
+        }
+
+        static void FillSpan(Colour* span, size_t count, Colour colour) {
+            size_t i = 0;
+#if defined(MATHCLASSES_AVX)
+            __m256i wide = _mm256_set1_epi32(static_cast<int>(colour.colour));
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&span[i]), wide);
+            }
+#endif
+#if defined(MATHCLASSES_SSE)
+            __m128i v = _mm_set1_epi32(static_cast<int>(colour.colour));
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&span[i]), v);
+            }
+#endif
+            for (; i < count; ++i) {
+                span[i] = colour;
+            }
+        }
+
+        // Trim a rectangle to this buffer, false if nothing is left
+        bool ClipRect(int& x, int& y, int& w, int& h) const {
+            if (x < 0) { w += x; x = 0; }
+            if (y < 0) { h += y; y = 0; }
+            if (x + w > width) { w = width - x; }
+            if (y + h > height) { h = height - y; }
+            return w > 0 && h > 0;
+        }
+
+        // Trim a copy so both the source and destination rectangles are in bounds
+        bool ClipCopy(const ColourBuffer& src, int& srcX, int& srcY, int& w, int& h, int& dstX, int& dstY) const {
+            int left = srcX < dstX ? srcX : dstX;
+            if (left < 0) { srcX -= left; dstX -= left; w += left; }
+            int top = srcY < dstY ? srcY : dstY;
+            if (top < 0) { srcY -= top; dstY -= top; h += top; }
+
+            if (srcX + w > src.width) { w = src.width - srcX; }
+            if (srcY + h > src.height) { h = src.height - srcY; }
+            if (dstX + w > width) { w = width - dstX; }
+            if (dstY + h > height) { h = height - dstY; }
+            return w > 0 && h > 0;
+        }
+
+        // Source coordinate of the centre of destination pixel i, in 16.16 fixed point
+        static int64_t SampleCentre(int i, int srcSize, int dstSize) {
+            return ((2 * static_cast<int64_t>(i) + 1) * srcSize << 16) / (2 * static_cast<int64_t>(dstSize));
+        }
+
+        // The two source pixels either side of destination pixel i, and the weight of the second
+        static void BilinearTaps(int i, int srcSize, int dstSize, int& first, int& second, int& weight) {
+            int64_t pos = SampleCentre(i, srcSize, dstSize) - (1 << 15);
+            if (pos < 0) {
+                pos = 0;
+            }
+            first = static_cast<int>(pos >> 16);
+            second = first + 1 < srcSize ? first + 1 : first;
+            weight = static_cast<int>((pos >> 8) & 0xff);
+        }
+
+        // out[i] = row[columns[i]] for length pixels
+        static void NearestRow(const Colour* row, const int* columns, Colour* out, int length) {
+            int i = 0;
+#if defined(MATHCLASSES_AVX2)
+            const int* source = reinterpret_cast<const int*>(row);
+            for (; i + 8 <= length; i += 8) {
+                __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&columns[i]));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), _mm256_i32gather_epi32(source, index, 4));
+            }
+#endif
+            for (; i < length; ++i) {
+                out[i] = row[columns[i]];
+            }
+        }
+
+        // One row of bilinear samples between source rows top and bottom.
+        // first, second and weights (four per pixel) are per output pixel.
+        static void BilinearRow(const Colour* top, const Colour* bottom, const int* first, const int* second,
+            const int16_t* weights, int fy, Colour* out, int length) {
+            int i = 0;
+#if defined(MATHCLASSES_SSE)
+            // four pixels at a time, two to a register once widened to 16 bits
+            __m128i zero = _mm_setzero_si128();
+            __m128i wy = _mm_set1_epi16(static_cast<short>(fy));
+            for (; i + 4 <= length; i += 4) {
+                __m128i tl = Gather(top, &first[i]), tr = Gather(top, &second[i]);
+                __m128i bl = Gather(bottom, &first[i]), br = Gather(bottom, &second[i]);
+                __m128i wxLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&weights[i * 4]));
+                __m128i wxHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&weights[i * 4 + 8]));
+
+                __m128i lo = LerpPairs(
+                    LerpPairs(_mm_unpacklo_epi8(tl, zero), _mm_unpacklo_epi8(tr, zero), wxLo),
+                    LerpPairs(_mm_unpacklo_epi8(bl, zero), _mm_unpacklo_epi8(br, zero), wxLo), wy);
+                __m128i hi = LerpPairs(
+                    LerpPairs(_mm_unpackhi_epi8(tl, zero), _mm_unpackhi_epi8(tr, zero), wxHi),
+                    LerpPairs(_mm_unpackhi_epi8(bl, zero), _mm_unpackhi_epi8(br, zero), wxHi), wy);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), _mm_packus_epi16(lo, hi));
+            }
+#endif
+            for (; i < length; ++i) {
+                out[i] = Bilinear(top[first[i]], top[second[i]], bottom[first[i]], bottom[second[i]], weights[i * 4], fy);
+            }
+        }
+
+#if defined(MATHCLASSES_SSE)
+        // row[columns[0 .. 3]] in one register
+        static __m128i Gather(const Colour* row, const int* columns) {
+            return _mm_setr_epi32(static_cast<int>(row[columns[0]].colour), static_cast<int>(row[columns[1]].colour),
+                static_cast<int>(row[columns[2]].colour), static_cast<int>(row[columns[3]].colour));
+        }
+
+        // (a * (256 - wb) + b * wb) >> 8 on 16-bit lanes, the same sums as LerpHalves
+        static __m128i LerpPairs(__m128i a, __m128i b, __m128i wb) {
+            __m128i wa = _mm_sub_epi16(_mm_set1_epi16(256), wb);
+            return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, wa), _mm_mullo_epi16(b, wb)), 8);
+        }
+
+        // (low half * low weights + high half * high weights) >> 8, into the low half.
+        // Weights sum to 256 so the total never passes 255 * 256 and fits unsigned 16 bits.
+        static __m128i LerpHalves(__m128i v, __m128i weights) {
+            __m128i product = _mm_mullo_epi16(v, weights);
+            return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_si128(product, 8)), 8);
+        }
+#else
+        static unsigned int Lerp(unsigned int a, unsigned int b, int weight) {
+            return (a * (256 - weight) + b * weight) >> 8;
+        }
+#endif
+    };
+}
@@ -0,0 +1,299 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+#include "Simd.h"
+#include "Colour.h"
+#include "Vector4.h"
+
+namespace MathClasses
+{
+    //
+    // COLOUR SPACE CONVERSION
+    //
+    // Colour holds gamma encoded (sRGB) channels, lighting and blending maths
+    // want them linear. Linear colours are arrays of floats, four per colour in
+    // R, G, B, A order with every channel in [0, 1]. Alpha is never gamma
+    // encoded so it is only scaled.
+    //
+    // Hue based colours are Vector4's of (hue, saturation, value or lightness,
+    // alpha), with hue in degrees [0, 360) and everything else in [0, 1].
+    //
+    struct ColourSpace
+    {
+        //
+        // sRGB <-> LINEAR
+        //
+
+        // Decoding goes through a 256 entry table, so it is exact
+        static float ToLinear(unsigned char channel) {
+            return DecodeTable()[channel];
+        }
+
+        // Encoding uses a polynomial in x^(1/2), x^(1/4) and x^(1/8) instead of
+        // powf. It is within 0.25 of an 8-bit step of the exact curve, and every
+        // channel value survives FromLinear(ToLinear(c)) unchanged.
+        static unsigned char FromLinear(float channel) {
+            // compared so that NaN fails and becomes 0
+            float c = channel > 0.0f ? channel : 0.0f;
+            c = c < 1.0f ? c : 1.0f;
+            float encoded;
+            if (c <= 0.0031308f) {
+                encoded = c * 12.92f;
+            }
+            else {
+                float s1 = sqrtf(c), s2 = sqrtf(s1), s3 = sqrtf(s2);
+                encoded = 0.662002687f * s1 + 0.684122060f * s2 - 0.323583601f * s3 - 0.0225411470f * c;
+            }
+            return Colour::FloatToByte(encoded);
+        }
+
+        // out must hold count * 4 floats
+        static void ToLinear(const Colour* in, float* out, size_t count) {
+            const float* table = DecodeTable();
+            const float toUnit = 1.0f / 255.0f;
+            for (size_t i = 0; i < count; ++i) {
+                out[i * 4 + 0] = table[in[i].GetRed()];
+                out[i * 4 + 1] = table[in[i].GetGreen()];
+                out[i * 4 + 2] = table[in[i].GetBlue()];
+                out[i * 4 + 3] = in[i].GetAlpha() * toUnit;
+            }
+        }
+
+        // in holds count * 4 floats, values outside [0, 1] are clamped
+        static void FromLinear(const float* in, Colour* out, size_t count) {
+            // a whole number of registers worth of colours at a time
+            const size_t BLOCK = FloatLanes::Width < 4 ? 1 : FloatLanes::Width / 4;
+            alignas(32) float encoded[BLOCK * 4];
+
+            size_t i = 0;
+            for (; i + BLOCK <= count; i += BLOCK) {
+                EncodeBlock(&in[i * 4], encoded, BLOCK * 4);
+                for (size_t j = 0; j < BLOCK; ++j) {
+                    out[i + j] = PackEncoded(&encoded[j * 4]);
+                }
+            }
+            for (; i < count; ++i) {
+                out[i] = Colour(FromLinear(in[i * 4 + 0]), FromLinear(in[i * 4 + 1]),
+                    FromLinear(in[i * 4 + 2]), Colour::FloatToByte(in[i * 4 + 3]));
+            }
+        }
+
+        //
+        // RGB <-> HSV / HSL
+        //
+        // The array versions work on FloatLanes::Width colours at a time, split
+        // into separate R, G, B channels so there are no per-pixel branches.
+        // The single colour versions run the same code, so they always agree.
+        //
+
+        static Vector4 ToHSV(Colour colour) {
+            Vector4 out;
+            ToHue<HueModel::HSV>(&colour, &out, 1);
+            return out;
+        }
+
+        static Colour FromHSV(const Vector4& hsv) {
+            Colour out;
+            FromHue<HueModel::HSV>(&hsv, &out, 1);
+            return out;
+        }
+
+        static Vector4 ToHSL(Colour colour) {
+            Vector4 out;
+            ToHue<HueModel::HSL>(&colour, &out, 1);
+            return out;
+        }
+
+        static Colour FromHSL(const Vector4& hsl) {
+            Colour out;
+            FromHue<HueModel::HSL>(&hsl, &out, 1);
+            return out;
+        }
+
+        static void ToHSV(const Colour* in, Vector4* out, size_t count) {
+            ToHue<HueModel::HSV>(in, out, count);
+        }
+
+        // Hues outside [0, 360) wrap round, other channels are clamped
+        static void FromHSV(const Vector4* in, Colour* out, size_t count) {
+            FromHue<HueModel::HSV>(in, out, count);
+        }
+
+        static void ToHSL(const Colour* in, Vector4* out, size_t count) {
+            ToHue<HueModel::HSL>(in, out, count);
+        }
+
+        static void FromHSL(const Vector4* in, Colour* out, size_t count) {
+            FromHue<HueModel::HSL>(in, out, count);
+        }
+
+    private:
+        static const float* DecodeTable() {
+            struct Table
+            {
+                float values[256];
+
+                Table() {
+                    for (int i = 0; i < 256; ++i) {
+                        float c = i / 255.0f;
+                        values[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+                    }
+                }
+            };
+            static const Table table;
+            return table.values;
+        }
+
+        enum class HueModel
+        {
+            HSV,
+            HSL
+        };
+
+        template <HueModel Model>
+        static void ToHue(const Colour* in, Vector4* out, size_t count) {
+            const size_t W = FloatLanes::Width;
+            alignas(32) float r[W], g[W], b[W], h[W], s[W], t[W];
+
+            FloatLanes zero = FloatLanes::Zero();
+            FloatLanes one = FloatLanes::Set(1.0f);
+            FloatLanes two = FloatLanes::Set(2.0f), four = FloatLanes::Set(4.0f);
+            FloatLanes sixty = FloatLanes::Set(60.0f), fullTurn = FloatLanes::Set(360.0f);
+            const float toUnit = 1.0f / 255.0f;
+
+            for (size_t i = 0; i < count; i += W) {
+                size_t n = count - i < W ? count - i : W;
+                for (size_t j = 0; j < W; ++j) {
+                    Colour c = j < n ? in[i + j] : Colour(0, 0, 0, 0);
+                    r[j] = c.GetRed() * toUnit;
+                    g[j] = c.GetGreen() * toUnit;
+                    b[j] = c.GetBlue() * toUnit;
+                }
+
+                FloatLanes R = FloatLanes::Load(r), G = FloatLanes::Load(g), B = FloatLanes::Load(b);
+                FloatLanes high = FloatLanes::Max(R, FloatLanes::Max(G, B));
+                FloatLanes low = FloatLanes::Min(R, FloatLanes::Min(G, B));
+                FloatLanes range = high - low;
+                FloatLanes grey = range <= zero;
+                FloatLanes invRange = FloatLanes::Select(grey, zero, one / FloatLanes::Select(grey, one, range));
+
+                // which channel is largest picks the sector, greys come out as hue 0
+                FloatLanes hue = FloatLanes::Select(R >= high, (G - B) * invRange,
+                    FloatLanes::Select(G >= high, (B - R) * invRange + two, (R - G) * invRange + four)) * sixty;
+                hue = FloatLanes::Select(hue < zero, hue + fullTurn, hue);
+                hue.Store(h);
+
+                if (Model == HueModel::HSV) {
+                    FloatLanes::Select(high > zero, range / FloatLanes::Select(high > zero, high, one), zero).Store(s);
+                    high.Store(t);
+                }
+                else {
+                    FloatLanes lightness = (high + low) * FloatLanes::Set(0.5f);
+                    // range / (1 - |2L - 1|)
+                    FloatLanes denominator = one - FloatLanes::Abs(lightness * two - one);
+                    FloatLanes::Select(grey, zero, range / FloatLanes::Select(grey, one, denominator)).Store(s);
+                    lightness.Store(t);
+                }
+
+                for (size_t j = 0; j < n; ++j) {
+                    out[i + j] = Vector4(h[j], s[j], t[j], in[i + j].GetAlpha() * toUnit);
+                }
+            }
+        }
+
+        template <HueModel Model>
+        static void FromHue(const Vector4* in, Colour* out, size_t count) {
+            const size_t W = FloatLanes::Width;
+            alignas(32) float h[W], s[W], t[W], r[W], g[W], b[W];
+
+            FloatLanes zero = FloatLanes::Zero();
+            FloatLanes one = FloatLanes::Set(1.0f);
+
+            for (size_t i = 0; i < count; i += W) {
+                size_t n = count - i < W ? count - i : W;
+                for (size_t j = 0; j < W; ++j) {
+                    Vector4 c = j < n ? in[i + j] : Vector4(0, 0, 0, 0);
+                    // hue as sixths (HSV) or twelfths (HSL) of a turn, wrapped into one turn
+                    float turns = c.x / 360.0f;
+                    turns -= floorf(turns);
+                    h[j] = turns * (Model == HueModel::HSV ? 6.0f : 12.0f);
+                    s[j] = c.y;
+                    t[j] = c.z;
+                }
+
+                FloatLanes H = FloatLanes::Load(h);
+                FloatLanes S = FloatLanes::Min(FloatLanes::Max(FloatLanes::Load(s), zero), one);
+                FloatLanes T = FloatLanes::Min(FloatLanes::Max(FloatLanes::Load(t), zero), one);
+
+                if (Model == HueModel::HSV) {
+                    // channel n is V - V * S * clamp(min(k, 4 - k), 0, 1), k = (n + H) mod 6
+                    FloatLanes six = FloatLanes::Set(6.0f), four = FloatLanes::Set(4.0f);
+                    FloatLanes chroma = T * S;
+                    const float offsets[3] = { 5.0f, 3.0f, 1.0f };
+                    float* channels[3] = { r, g, b };
+                    for (int c = 0; c < 3; ++c) {
+                        FloatLanes k = H + FloatLanes::Set(offsets[c]);
+                        k = FloatLanes::Select(k >= six, k - six, k);
+                        FloatLanes f = FloatLanes::Max(FloatLanes::Min(FloatLanes::Min(k, four - k), one), zero);
+                        (T - chroma * f).Store(channels[c]);
+                    }
+                }
+                else {
+                    // channel n is L - A * clamp(min(k - 3, 9 - k), -1, 1), k = (n + H) mod 12
+                    FloatLanes twelve = FloatLanes::Set(12.0f), three = FloatLanes::Set(3.0f), nine = FloatLanes::Set(9.0f);
+                    FloatLanes a = S * FloatLanes::Min(T, one - T);
+                    const float offsets[3] = { 0.0f, 8.0f, 4.0f };
+                    float* channels[3] = { r, g, b };
+                    for (int c = 0; c < 3; ++c) {
+                        FloatLanes k = H + FloatLanes::Set(offsets[c]);
+                        k = FloatLanes::Select(k >= twelve, k - twelve, k);
+                        FloatLanes f = FloatLanes::Max(FloatLanes::Min(FloatLanes::Min(k - three, nine - k), one), zero - one);
+                        (T - a * f).Store(channels[c]);
+                    }
+                }
+
+                for (size_t j = 0; j < n; ++j) {
+                    out[i + j] = Colour(Colour::FloatToByte(r[j]), Colour::FloatToByte(g[j]), Colour::FloatToByte(b[j]), Colour::FloatToByte(in[i + j].w));
+                }
+            }
+        }
+
+        static Colour PackEncoded(const float* rgba) {
+            return Colour(static_cast<unsigned char>(rgba[0]), static_cast<unsigned char>(rgba[1]),
+                static_cast<unsigned char>(rgba[2]), static_cast<unsigned char>(rgba[3]));
+        }
+
+        // Same maths as FromLinear(float) on a register at a time, leaving
+        // out[i] as the clamped, rounded byte value still held in a float
+        static void EncodeBlock(const float* in, float* out, size_t floatCount) {
+            // 1 in the alpha lanes, offset by i & 3 so it also lines up for narrower registers
+            alignas(32) static const float ALPHA_LANES[12] = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+
+            FloatLanes zero = FloatLanes::Zero();
+            FloatLanes one = FloatLanes::Set(1.0f);
+            FloatLanes linearEnd = FloatLanes::Set(0.0031308f);
+            FloatLanes linearScale = FloatLanes::Set(12.92f);
+            FloatLanes k1 = FloatLanes::Set(0.662002687f), k2 = FloatLanes::Set(0.684122060f);
+            FloatLanes k3 = FloatLanes::Set(-0.323583601f), k4 = FloatLanes::Set(-0.0225411470f);
+            FloatLanes byteScale = FloatLanes::Set(255.0f), half = FloatLanes::Set(0.5f);
+
+            for (size_t i = 0; i < floatCount; i += FloatLanes::Width) {
+                FloatLanes c = FloatLanes::Min(FloatLanes::Max(FloatLanes::LoadUnaligned(&in[i]), zero), one);
+
+                FloatLanes s1 = FloatLanes::Sqrt(c);
+                FloatLanes s2 = FloatLanes::Sqrt(s1);
+                FloatLanes s3 = FloatLanes::Sqrt(s2);
+                FloatLanes curve = k1 * s1 + k2 * s2 + k3 * s3 + k4 * c;
+                FloatLanes encoded = FloatLanes::Select(c <= linearEnd, c * linearScale, curve);
+
+                FloatLanes isAlpha = FloatLanes::LoadUnaligned(&ALPHA_LANES[i & 3]) > zero;
+                encoded = FloatLanes::Select(isAlpha, c, encoded);
+
+                // the curve can overshoot 1 by a hair, so clamp after scaling
+                FloatLanes scaled = FloatLanes::Min(encoded * byteScale + half, byteScale);
+                scaled.Store(&out[i]);
+            }
+        }
+    };
+}
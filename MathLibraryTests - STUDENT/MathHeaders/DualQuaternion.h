@@ -0,0 +1,173 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+
+namespace MathClasses
+{
+    //
+    // DUAL QUATERNIONS
+    //
+    // A rotation and a translation in eight floats: real is the rotation and
+    // dual is half the translation times the rotation. Same conventions as
+    // Quaternion, so a * b applies b first.
+    //
+    // Blending a set of them by weight and normalising gives a rigid
+    // transform in between, which is what makes them good for skinning: no
+    // shrinking at twisted joints the way blended matrices do.
+    //
+    struct DualQuaternion
+    {
+        Quaternion real, dual;
+
+        // Default constructor - identity
+        DualQuaternion() : real{ 0, 0, 0, 1 }, dual{ 0, 0, 0, 0 } {}
+
+        DualQuaternion(const Quaternion& real, const Quaternion& dual) : real{ real }, dual{ dual } {}
+
+        static DualQuaternion MakeIdentity() {
+            return DualQuaternion();
+        }
+
+        // Rotate by rotation (a unit quaternion), then move by translation
+        static DualQuaternion MakeRotationTranslation(const Quaternion& rotation, const Vector3& translation) {
+            Quaternion t(translation.x, translation.y, translation.z, 0);
+            return DualQuaternion(rotation, t * rotation * 0.5f);
+        }
+
+        static DualQuaternion MakeTranslation(const Vector3& translation) {
+            return MakeRotationTranslation(Quaternion(), translation);
+        }
+
+        //
+        // Maths Operators
+
+        // operator * (DualQuaternion, DualQuaternion) - rhs is applied first
+        DualQuaternion operator *(const DualQuaternion& rhs) const {
+            return DualQuaternion(real * rhs.real, real * rhs.dual + dual * rhs.real);
+        }
+
+        // operator * (DualQuaternion, float) - component-wise, used for blending
+        DualQuaternion operator *(float rhs) const {
+            return DualQuaternion(real * rhs, dual * rhs);
+        }
+
+        // operator + (DualQuaternion, DualQuaternion) - component-wise, used for blending
+        DualQuaternion operator +(const DualQuaternion& rhs) const {
+            return DualQuaternion(real + rhs.real, dual + rhs.dual);
+        }
+
+        // Compares components, so dq and -dq are not equal
+        bool operator ==(const DualQuaternion& rhs) const {
+            return real == rhs.real && dual == rhs.dual;
+        }
+
+        bool operator !=(const DualQuaternion& rhs) const {
+            return !(*this == rhs);
+        }
+
+        std::string ToString() const {
+            return real.ToString() + " | " + dual.ToString();
+        }
+
+        //
+        // NORMALISATION
+        //
+
+        // Scale to a unit real part and take out any part of dual along
+        // real, which blending leaves behind. A zero real part is left untouched.
+        void Normalise() {
+            float m = real.Magnitude();
+            if (m == 0.0f) {
+                return;
+            }
+            float inv = 1.0f / m;
+            real = real * inv;
+            dual = dual * inv;
+            dual = dual + real * -real.Dot(dual);
+        }
+
+        DualQuaternion Normalised() const {
+            DualQuaternion copy = *this;
+            copy.Normalise();
+
+            return copy;
+        }
+
+        // For unit dual quaternions this is also the inverse
+        DualQuaternion Conjugate() const {
+            return DualQuaternion(real.Conjugate(), dual.Conjugate());
+        }
+
+        //
+        // PARTS
+        //
+
+        // Expects a unit dual quaternion
+        const Quaternion& GetRotation() const { return real; }
+
+        // Expects a unit dual quaternion
+        Vector3 GetTranslation() const {
+            Quaternion t = dual * real.Conjugate();
+            return Vector3(t.x, t.y, t.z) * 2.0f;
+        }
+
+        // Expects a unit dual quaternion
+        Vector3 TransformPoint(const Vector3& point) const {
+            return real.Rotate(point) + GetTranslation();
+        }
+
+        // Rotation only, for directions and normals
+        Vector3 TransformVector(const Vector3& vec) const {
+            return real.Rotate(vec);
+        }
+
+        // Expects a unit dual quaternion
+        Matrix4 ToMatrix4() const {
+            Matrix4 m = real.ToMatrix4();
+            Vector3 t = GetTranslation();
+            m.axis[3] = Vector4(t.x, t.y, t.z, 1);
+            return m;
+        }
+
+        //
+        // BLENDING
+        //
+
+        // Weighted sum of palette[bones[i]] for count bones, normalised. Each
+        // one is flipped onto the same side as the first where needed, as dq
+        // and -dq are the same transform but would cancel each other out.
+        static DualQuaternion Blend(const DualQuaternion* palette, const uint16_t* bones, const float* weights, size_t count) {
+            if (count == 0) {
+                return DualQuaternion();
+            }
+            const Quaternion& pivot = palette[bones[0]].real;
+            DualQuaternion sum(Quaternion(0, 0, 0, 0), Quaternion(0, 0, 0, 0));
+            for (size_t i = 0; i < count; ++i) {
+                const DualQuaternion& bone = palette[bones[i]];
+                float w = pivot.Dot(bone.real) < 0.0f ? -weights[i] : weights[i];
+                sum = sum + bone * w;
+            }
+            return sum.Normalised();
+        }
+
+        // Batch versions
+        static void Normalise(const DualQuaternion* in, DualQuaternion* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = in[i].Normalised();
+            }
+        }
+
+        static void ToMatrix4(const DualQuaternion* in, Matrix4* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = in[i].ToMatrix4();
+            }
+        }
+    };
+}
@@ -0,0 +1,231 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "Simd.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+#include "AABB.h"
+#include "Vector3SoA.h"
+
+namespace MathClasses
+{
+    // Depth range a projection matrix maps the near and far planes to
+    enum class ClipDepth
+    {
+        // OpenGL style, near at -1
+        NegativeOneToOne,
+        // Direct3D / Vulkan style, near at 0
+        ZeroToOne
+    };
+
+    //
+    // VIEW FRUSTUMS
+    //
+    // Six planes stored as Vector4's (normal x, y, z, distance), normals
+    // pointing inwards, so a point p is inside a plane when
+    // normal . p + distance >= 0.
+    //
+    // Culling is conservative: anything touching the frustum is visible, and
+    // a few things just outside a corner may be too.
+    //
+    struct Frustum
+    {
+        // NEAR and FAR on their own are macros in the Windows headers
+        enum PlaneIndex
+        {
+            LEFT_PLANE,
+            RIGHT_PLANE,
+            BOTTOM_PLANE,
+            TOP_PLANE,
+            NEAR_PLANE,
+            FAR_PLANE,
+            PLANE_COUNT
+        };
+
+        Vector4 planes[PLANE_COUNT];
+
+        // Extract the planes from a view-projection matrix (Gribb & Hartmann).
+        // Each plane is the fourth row of the matrix plus or minus one of the others.
+        static Frustum MakeFromMatrix(const Matrix4& viewProjection, ClipDepth depth = ClipDepth::NegativeOneToOne) {
+            const Matrix4& m = viewProjection;
+            Vector4 rows[4];
+            for (int r = 0; r < 4; ++r) {
+                rows[r] = Vector4(m.mm[0][r], m.mm[1][r], m.mm[2][r], m.mm[3][r]);
+            }
+
+            Frustum f;
+            f.planes[LEFT_PLANE] = rows[3] + rows[0];
+            f.planes[RIGHT_PLANE] = rows[3] - rows[0];
+            f.planes[BOTTOM_PLANE] = rows[3] + rows[1];
+            f.planes[TOP_PLANE] = rows[3] - rows[1];
+            f.planes[NEAR_PLANE] = depth == ClipDepth::NegativeOneToOne ? rows[3] + rows[2] : rows[2];
+            f.planes[FAR_PLANE] = rows[3] - rows[2];
+
+            // unit normals so distances are real distances, which sphere tests need
+            for (Vector4& plane : f.planes) {
+                float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+                if (length > 0.0f) {
+                    plane = plane / length;
+                }
+            }
+            return f;
+        }
+
+        // Signed distance from a plane, positive on the inside
+        static float Distance(const Vector4& plane, const Vector3& point) {
+            return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+        }
+
+        bool Contains(const Vector3& point) const {
+            for (const Vector4& plane : planes) {
+                if (Distance(plane, point) < 0.0f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // sphere is (centre x, y, z, radius), negative radii count as empty
+        bool IntersectsSphere(const Vector4& sphere) const {
+            if (sphere.w < 0.0f) {
+                return false;
+            }
+            Vector3 centre(sphere.x, sphere.y, sphere.z);
+            for (const Vector4& plane : planes) {
+                if (Distance(plane, centre) < -sphere.w) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool Intersects(const AABB& box) const {
+            if (box.IsEmpty()) {
+                return false;
+            }
+            Vector3 centre = box.Centre(), extents = box.Extents();
+            for (const Vector4& plane : planes) {
+                // how far the box reaches towards the plane normal
+                float reach = fabsf(plane.x) * extents.x + fabsf(plane.y) * extents.y + fabsf(plane.z) * extents.z;
+                if (Distance(plane, centre) < -reach) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //
+        // BATCH CULLING
+        //
+        // Tests FloatLanes::Width objects at a time and writes one bit per
+        // object, bit i % 32 of visible[i / 32], set for visible objects.
+        // visible must hold MaskWords(count) words, all of which are overwritten.
+        //
+
+        static size_t MaskWords(size_t count) {
+            return (count + 31) / 32;
+        }
+
+        static bool IsVisible(const uint32_t* visible, size_t i) {
+            return (visible[i / 32] >> (i % 32)) & 1;
+        }
+
+        // spheres are (centre x, y, z, radius)
+        void CullSpheres(const Vector4* spheres, size_t count, uint32_t* visible) const {
+            const size_t W = FloatLanes::Width;
+            alignas(32) float x[W], y[W], z[W], r[W];
+
+            ClearMask(visible, count);
+            for (size_t i = 0; i < count; i += W) {
+                size_t n = count - i < W ? count - i : W;
+                for (size_t j = 0; j < W; ++j) {
+                    const Vector4& s = spheres[j < n ? i + j : i];
+                    x[j] = s.x;
+                    y[j] = s.y;
+                    z[j] = s.z;
+                    r[j] = s.w;
+                }
+                WriteMask(visible, i, n, SphereLanes(FloatLanes::Load(x), FloatLanes::Load(y), FloatLanes::Load(z), FloatLanes::Load(r)));
+            }
+        }
+
+        // Structure-of-arrays version, radii holds centres.Size() floats
+        void CullSpheres(const Vector3SoA& centres, const float* radii, uint32_t* visible) const {
+            const size_t W = FloatLanes::Width;
+            size_t count = centres.Size();
+            alignas(32) float r[W] = {};
+
+            ClearMask(visible, count);
+            for (size_t i = 0; i < count; i += W) {
+                size_t n = count - i < W ? count - i : W;
+                for (size_t j = 0; j < n; ++j) {
+                    r[j] = radii[i + j];
+                }
+                FloatLanes mask = SphereLanes(FloatLanes::Load(&centres.x[i]), FloatLanes::Load(&centres.y[i]),
+                    FloatLanes::Load(&centres.z[i]), FloatLanes::Load(r));
+                WriteMask(visible, i, n, mask);
+            }
+        }
+
+        void CullAABBs(const AABB* boxes, size_t count, uint32_t* visible) const {
+            const size_t W = FloatLanes::Width;
+            alignas(32) float cx[W], cy[W], cz[W], ex[W], ey[W], ez[W];
+
+            ClearMask(visible, count);
+            FloatLanes zero = FloatLanes::Zero();
+            for (size_t i = 0; i < count; i += W) {
+                size_t n = count - i < W ? count - i : W;
+                for (size_t j = 0; j < W; ++j) {
+                    const AABB& box = boxes[j < n ? i + j : i];
+                    // empty boxes get negative extents, which are caught below
+                    cx[j] = (box.min.x + box.max.x) * 0.5f;
+                    cy[j] = (box.min.y + box.max.y) * 0.5f;
+                    cz[j] = (box.min.z + box.max.z) * 0.5f;
+                    ex[j] = (box.max.x - box.min.x) * 0.5f;
+                    ey[j] = (box.max.y - box.min.y) * 0.5f;
+                    ez[j] = (box.max.z - box.min.z) * 0.5f;
+                }
+
+                FloatLanes CX = FloatLanes::Load(cx), CY = FloatLanes::Load(cy), CZ = FloatLanes::Load(cz);
+                FloatLanes EX = FloatLanes::Load(ex), EY = FloatLanes::Load(ey), EZ = FloatLanes::Load(ez);
+                FloatLanes mask = (EX >= zero) & (EY >= zero) & (EZ >= zero);
+                for (const Vector4& plane : planes) {
+                    FloatLanes distance = FloatLanes::Set(plane.x) * CX + FloatLanes::Set(plane.y) * CY +
+                        FloatLanes::Set(plane.z) * CZ + FloatLanes::Set(plane.w);
+                    FloatLanes reach = FloatLanes::Set(fabsf(plane.x)) * EX + FloatLanes::Set(fabsf(plane.y)) * EY +
+                        FloatLanes::Set(fabsf(plane.z)) * EZ;
+                    mask = mask & (distance + reach >= zero);
+                }
+                WriteMask(visible, i, n, mask);
+            }
+        }
+
+    private:
+        FloatLanes SphereLanes(FloatLanes x, FloatLanes y, FloatLanes z, FloatLanes r) const {
+            FloatLanes zero = FloatLanes::Zero();
+            FloatLanes mask = r >= zero;
+            for (const Vector4& plane : planes) {
+                FloatLanes distance = FloatLanes::Set(plane.x) * x + FloatLanes::Set(plane.y) * y +
+                    FloatLanes::Set(plane.z) * z + FloatLanes::Set(plane.w);
+                mask = mask & (distance + r >= zero);
+            }
+            return mask;
+        }
+
+        static void ClearMask(uint32_t* visible, size_t count) {
+            for (size_t w = 0; w < MaskWords(count); ++w) {
+                visible[w] = 0;
+            }
+        }
+
+        // Width divides 32, so a block of lanes never straddles two words
+        static void WriteMask(uint32_t* visible, size_t first, size_t n, FloatLanes mask) {
+            uint32_t bits = static_cast<uint32_t>(FloatLanes::MoveMask(mask));
+            bits &= n >= 32 ? ~0u : (1u << n) - 1;
+            visible[first / 32] |= bits << (first % 32);
+        }
+    };
+}
@@ -1,9 +1,14 @@
 #pragma once
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
 
 namespace MathClasses
 {
-#include "Vector3.h"
-#include <string>
 	using namespace std;
 
     struct Matrix3
@@ -166,6 +171,59 @@ namespace MathClasses
             return Matrix3(m1, m4, m7, m2, m5, m8, m3, m6, m9);
         }
 
+        //
+        // Determinant & Inverse
+
+        float Determinant() const {
+            return axis[0].Dot(axis[1].Cross(axis[2]));
+        }
+
+        // The rows of the inverse are the cross products of pairs of columns
+        // over the determinant. A singular matrix gives back an all-zero matrix.
+        Matrix3 Inverse() const {
+            Vector3 r0 = axis[1].Cross(axis[2]);
+            Vector3 r1 = axis[2].Cross(axis[0]);
+            Vector3 r2 = axis[0].Cross(axis[1]);
+
+            float det = axis[0].Dot(r0);
+            if (det == 0.0f) {
+                return Matrix3();
+            }
+            float invDet = 1.0f / det;
+
+            return Matrix3(r0.x * invDet, r1.x * invDet, r2.x * invDet,
+                r0.y * invDet, r1.y * invDet, r2.y * invDet,
+                r0.z * invDet, r1.z * invDet, r2.z * invDet);
+        }
+
+        //
+        // Normal Matrices
+        //
+        // The inverse-transpose of each model matrix's 3x3 block, for transforming
+        // normals. That's the same cross products as Inverse() without the final
+        // transpose, so each column comes straight out of one cross product.
+        // Singular blocks give back an all-zero matrix.
+        static void ComputeNormalMatrices(const Matrix4* models, Matrix3* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                const Vector4& c0 = models[i].axis[0];
+                const Vector4& c1 = models[i].axis[1];
+                const Vector4& c2 = models[i].axis[2];
+
+                // Vector4's cross product ignores w, so the model's bottom row doesn't matter
+                Vector4 n0 = c1.Cross(c2);
+                Vector4 n1 = c2.Cross(c0);
+                Vector4 n2 = c0.Cross(c1);
+
+                float det = c0.Dot(n0);
+                float invDet = det == 0.0f ? 0.0f : 1.0f / det;
+                n0 *= invDet;
+                n1 *= invDet;
+                n2 *= invDet;
+
+                out[i] = Matrix3(n0.x, n0.y, n0.z, n1.x, n1.y, n1.z, n2.x, n2.y, n2.z);
+            }
+        }
+
         //
         // ToString
 
@@ -190,9 +248,9 @@ namespace MathClasses
 
         // Rotate Y-axis
         static Matrix3 MakeRotateY(float a) {
-            return Matrix3(cosf(a), 0, -sinf(a), 
+            return Matrix3(cosf(a), 0, sinf(a), 
                 0, 1, 0, 
-                sinf(a), 0, cosf(a));
+                -sinf(a), 0, cosf(a));
         }
 
         // Rotate Z-axis
@@ -214,13 +272,23 @@ namespace MathClasses
         //
         // Euler Angle Rotations
 
+        // Same result as MakeRotateZ(roll) * MakeRotateY(yaw) * MakeRotateX(pitch),
+        // but with one sin/cos per angle and the entries written out directly
         static Matrix3 MakeEuler(float pitch, float yaw, float roll) {
-            Matrix3 x = MakeRotateX(pitch);
-            Matrix3 y = MakeRotateY(yaw);
-            Matrix3 z = MakeRotateZ(roll);
+            float sx = sinf(pitch), cx = cosf(pitch);
+            float sy = sinf(yaw), cy = cosf(yaw);
+            float sz = sinf(roll), cz = cosf(roll);
 
-            // combine rotations in a specific order
-            return (z * y * x);
+            return Matrix3(cz * cy, sz * cy, sy,
+                cz * sy * sx - sz * cx, cz * cx + sz * sy * sx, -cy * sx,
+                -cz * sy * cx - sz * sx, cz * sx - sz * sy * cx, cy * cx);
+        }
+
+        // Batch version, angles holds (pitch, yaw, roll) triples
+        static void MakeEuler(const Vector3* angles, Matrix3* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = MakeEuler(angles[i].x, angles[i].y, angles[i].z);
+            }
         }
 
         static Matrix3 MakeScale(float xScale, float yScale, float zScale) {
@@ -1,10 +1,17 @@
 #pragma once
+#include <cstddef>
+#include <string>
+
+#include "Vector3.h"
+#include "Vector4.h"
+
 namespace MathClasses
 {
-#include "Vector4.h"
-#include <string>
     using namespace std;
 
+	// see the end of Quaternion.h
+	struct Quaternion;
+
 	struct Matrix4
 	{
 		union
@@ -94,11 +101,11 @@ namespace MathClasses
 		// Maths Operators
 
 		// operator +=
-		Matrix4& operator +=(const Matrix3& rhs)
+		Matrix4& operator +=(const Matrix4& rhs)
 		{
 			for (int i = 0; i < 16; i++)
 			{
-				v[i += rhs.v[i]];
+				v[i] += rhs.v[i];
 			}
 			return *this;
 		}
@@ -133,7 +140,7 @@ namespace MathClasses
 		// operator ==(Matrix, Matrix)
 		bool operator ==(const Matrix4& rhs) const
 		{
-			for (int i = 0; i < 9; i++)
+			for (int i = 0; i < 16; i++)
 			{
 				if (fabs(v[i] - rhs.v[i]) > 1e-6f)
 				{
@@ -150,364 +157,451 @@ namespace MathClasses
 		}
 
 		// Matrix Multiplication
-		Matrix4 operator *(const Matrix4 rhs) const
+		//
+		// Each column of the result is our four columns weighted by the matching
+		// column of rhs, so we broadcast one element of rhs at a time and
+		// accumulate whole columns instead of doing 16 separate dot products.
+		// All three paths sum in the same order and give identical results.
+		Matrix4 operator *(const Matrix4& rhs) const
 		{
 			// stores the return value
 			Matrix4 result;
 
-			// iterate through first matrix
-			for (size_t i = 0; i < 4; ++i)
+#if defined(MATHCLASSES_AVX)
+			// two result columns per iteration, one in each 128-bit lane
+			__m256 c0 = _mm256_broadcast_ps(&axis[0].simd);
+			__m256 c1 = _mm256_broadcast_ps(&axis[1].simd);
+			__m256 c2 = _mm256_broadcast_ps(&axis[2].simd);
+			__m256 c3 = _mm256_broadcast_ps(&axis[3].simd);
+
+			for (size_t j = 0; j < 4; j += 2)
+			{
+				__m256 b = _mm256_loadu_ps(rhs.mm[j]);
+
+				__m256 r = _mm256_mul_ps(c0, _mm256_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+				r = _mm256_add_ps(r, _mm256_mul_ps(c1, _mm256_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+				r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+				r = _mm256_add_ps(r, _mm256_mul_ps(c3, _mm256_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+
+				_mm256_storeu_ps(result.mm[j], r);
+			}
+#elif defined(MATHCLASSES_SSE)
+			for (size_t j = 0; j < 4; ++j)
 			{
-				// current row from first matrix
-				Vector4 row(mm[0][i], mm[1][i], mm[2][i]);
+				__m128 b = rhs.axis[j].simd;
+
+				__m128 r = _mm_mul_ps(axis[0].simd, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+				r = _mm_add_ps(r, _mm_mul_ps(axis[1].simd, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+				r = _mm_add_ps(r, _mm_mul_ps(axis[2].simd, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+				r = _mm_add_ps(r, _mm_mul_ps(axis[3].simd, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
 
-				// iterate through columns in the second matrix
-				for (size_t j = 0; j < 4; ++j)
+				result.axis[j].simd = r;
+			}
+#else
+			// scalar reference path
+			for (size_t j = 0; j < 4; ++j)
+			{
+				for (size_t i = 0; i < 4; ++i)
 				{
-					// dot each row with each column and assign to result matrix
-					// result is calculated row-by-row
-					result.mm[j][i] = row.Dot(rhs.axis[j]);
+					result.mm[j][i] = mm[0][i] * rhs.mm[j][0] + mm[1][i] * rhs.mm[j][1] +
+						mm[2][i] * rhs.mm[j][2] + mm[3][i] * rhs.mm[j][3];
 				}
 			}
+#endif
 			return result;
 		}
 
 		// Matrix Multiplication against a Vector
-		Vector4 operator *(const Vector4 rhs) const
+		Vector4 operator *(const Vector4& rhs) const
 		{
-			return Vector4(
-				Vector4(m1, m5, m9, m13).Dot(rhs),
-				Vector4(m2, m6, m10, m14).Dot(rhs),
-				Vector4(m3, m7, m11, m15).Dot(rhs),
-				Vector4(m4, m8, m12, m16).Dot(rhs)
-			);
+#ifdef MATHCLASSES_SSE
+			__m128 b = rhs.simd;
+			__m128 r = _mm_mul_ps(axis[0].simd, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm_add_ps(r, _mm_mul_ps(axis[1].simd, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+			r = _mm_add_ps(r, _mm_mul_ps(axis[2].simd, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+			r = _mm_add_ps(r, _mm_mul_ps(axis[3].simd, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+			return Vector4(r);
+#else
+			return axis[0] * rhs.x + axis[1] * rhs.y + axis[2] * rhs.z + axis[3] * rhs.w;
+#endif
 		}
 
 		//
-		// Matrix4 Transposition
-		Matrix4 Transposed() const
-		{
-			return Matrix4(m1, m5, m9, m13, m2, m6, m10, m14, m3, m7, m11, m15, m4, m8, m12, m16);
-		}
-
+		// Batch Transforms
 		//
-		// ToString
-		string ToString() const
+		// Stream count vectors from in to out with the matrix held in registers.
+		// in and out may be the same array to transform in place, but must not
+		// otherwise overlap. Points are treated as w = 1 and directions as w = 0;
+		// the Vector3 versions assume an affine matrix and drop the resulting w.
+
+		void TransformPoints(const Vector3* in, Vector3* out, size_t count) const
 		{
-			string str = to_string(v[0]);
-			for (size_t i = 1; i < 16; ++i)
+#ifdef MATHCLASSES_SSE
+			__m128 c0 = axis[0].simd, c1 = axis[1].simd, c2 = axis[2].simd, c3 = axis[3].simd;
+			for (size_t i = 0; i < count; ++i)
 			{
-				str += "," + to_string(v[i]);
+				__m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(in[i].x)), _mm_mul_ps(c1, _mm_set1_ps(in[i].y)));
+				r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
+				r = _mm_add_ps(r, c3);
+
+				// write back only xyz, the elements are 12 bytes apart
+				_mm_storel_pi(reinterpret_cast<__m64*>(&out[i].x), r);
+				_mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
 			}
-			return str;
+#else
+			for (size_t i = 0; i < count; ++i)
+			{
+				Vector3 p = in[i];
+				out[i].x = m1 * p.x + m5 * p.y + m9 * p.z + m13;
+				out[i].y = m2 * p.x + m6 * p.y + m10 * p.z + m14;
+				out[i].z = m3 * p.x + m7 * p.y + m11 * p.z + m15;
+			}
+#endif
 		}
 
-		//
-		// Matrix transformations
-		//
-
-		// Rotate X-axis
-		static Matrix4 MakeRotateX(float a)
+		void TransformDirections(const Vector3* in, Vector3* out, size_t count) const
 		{
-			return Matrix4(1, 0, 0, 0,
-				0, cosf(a), -sinf(a), 0,
-				0, sinf(a), cosf(a), 0,
-				0, 0, 0, 1);
-		}
+#ifdef MATHCLASSES_SSE
+			__m128 c0 = axis[0].simd, c1 = axis[1].simd, c2 = axis[2].simd;
+			for (size_t i = 0; i < count; ++i)
+			{
+				__m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(in[i].x)), _mm_mul_ps(c1, _mm_set1_ps(in[i].y)));
+				r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
 
-		// Rotate y-axis
-		static Matrix4 MakeRotateY(float a)
-		{
-			return Matrix4(cosf(a), 0, -sinf(a), 0,
-				0, 1, 0, 0,
-				sinf(a), 0, cosf(a), 0,
-				0, 0, 0, 1);
+				_mm_storel_pi(reinterpret_cast<__m64*>(&out[i].x), r);
+				_mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
+			}
+#else
+			for (size_t i = 0; i < count; ++i)
+			{
+				Vector3 d = in[i];
+				out[i].x = m1 * d.x + m5 * d.y + m9 * d.z;
+				out[i].y = m2 * d.x + m6 * d.y + m10 * d.z;
+				out[i].z = m3 * d.x + m7 * d.y + m11 * d.z;
+			}
+#endif
 		}
 
-		// Rotate z-axis
-		static Matrix4 MakeRotateZ(float a)
+		// the input w is ignored, the output w is whatever the matrix produces
+		void TransformPoints(const Vector4* in, Vector4* out, size_t count) const
 		{
-			return Matrix4(cosf(a), sinf(a), 0, 0,
-				-sinf(a), cosf(a), 0, 0,
-				0, 0, 1, 0,
-				0, 0, 0, 1);
-		}
-	};
-}
-
-/*
-#pragma once
-
-namespace MathClasses
-{
-#include "Vector4.h"
-#include <string>
-	using namespace std;
-
-	struct Matrix4
-	{
-		union {
-			// as individual floats
-			struct
+#ifdef MATHCLASSES_SSE
+			__m128 c0 = axis[0].simd, c1 = axis[1].simd, c2 = axis[2].simd, c3 = axis[3].simd;
+			for (size_t i = 0; i < count; ++i)
 			{
-				float m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16;
-			};
-
-			// as a 1-D array
-			float v[16];
-
-			// as a 2-D array
-			float mm[4][4];
-
-			// as Vector4's
-			Vector4 axis[4];
-		};
-
-		// Default Constructor - zero initializes all values
-		Matrix4() {
-			m1 = m2 = m3 = m4 = m5 = m6 = m7 = m8 = m9 = m10 = m11 = m12 = m13 = m14 = m15 = m16 = 0.0f;
-		}
-
-		// Constructor using const m1 - m16
-		Matrix4(const float m1, const float m2, const float m3, const float m4,
-				const float m5, const float m6, const float m7, const float m8,
-				const float m9, const float m10, const float m11, const float m12,
-				const float m13, const float m14, const float m15, const float m16) {
-			this->m1 = m1;
-			this->m2 = m2;
-			this->m3 = m3;
-			this->m4 = m4;
-			this->m5 = m5;
-			this->m6 = m6;
-			this->m7 = m7;
-			this->m8 = m8;
-			this->m9 = m9;
-			this->m10 = m10;
-			this->m11 = m11;
-			this->m12 = m12;
-			this->m13 = m13;
-			this->m14 = m14;
-			this->m15 = m15;
-			this->m16 = m16;
+				__m128 b = in[i].simd;
+				__m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0))),
+					_mm_mul_ps(c1, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+				r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+				out[i].simd = _mm_add_ps(r, c3);
+			}
+#else
+			for (size_t i = 0; i < count; ++i)
+			{
+				Vector4 p = in[i];
+				out[i] = axis[0] * p.x + axis[1] * p.y + axis[2] * p.z + axis[3];
+			}
+#endif
 		}
 
-		static Matrix4 MakeIdentity() {
-			Matrix4 identity;
-			identity.m1 = 1;
-			identity.m2 = 0;
-			identity.m3 = 0;
-			identity.m4 = 0;
-
-			identity.m5 = 0;
-			identity.m6 = 1;
-			identity.m7 = 0;
-			identity.m8 = 0;
-
-			identity.m9 = 0;
-			identity.m10 = 0;
-			identity.m11 = 1;
-			identity.m12 = 0;
-
-			identity.m13 = 0;
-			identity.m14 = 0;
-			identity.m15 = 0;
-			identity.m16 = 1;
-
-			return identity;
+		// the input w is ignored, the output w is whatever the matrix produces
+		void TransformDirections(const Vector4* in, Vector4* out, size_t count) const
+		{
+#ifdef MATHCLASSES_SSE
+			__m128 c0 = axis[0].simd, c1 = axis[1].simd, c2 = axis[2].simd;
+			for (size_t i = 0; i < count; ++i)
+			{
+				__m128 b = in[i].simd;
+				__m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0))),
+					_mm_mul_ps(c1, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+				out[i].simd = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+			}
+#else
+			for (size_t i = 0; i < count; ++i)
+			{
+				Vector4 d = in[i];
+				out[i] = axis[0] * d.x + axis[1] * d.y + axis[2] * d.z;
+			}
+#endif
 		}
 
-		// mutable access to each element
-		float& operator [](int dim) {
-			return v[dim];
-		}
+		// in-place versions
+		void TransformPoints(Vector3* points, size_t count) const { TransformPoints(points, points, count); }
+		void TransformDirections(Vector3* directions, size_t count) const { TransformDirections(directions, directions, count); }
+		void TransformPoints(Vector4* points, size_t count) const { TransformPoints(points, points, count); }
+		void TransformDirections(Vector4* directions, size_t count) const { TransformDirections(directions, directions, count); }
 
-		// const-qualified access to each element
-		const float& operator [](int dim) const {
-			return v[dim];
+		//
+		// Matrix4 Transposition
+		Matrix4 Transposed() const
+		{
+			return Matrix4(m1, m5, m9, m13, m2, m6, m10, m14, m3, m7, m11, m15, m4, m8, m12, m16);
 		}
 
 		//
-		// Maths Operators
+		// Determinant & Inverse
+		//
+		// Both are worked out from the 2x2 minors of the top and bottom halves.
+		// Indexing mm[][] as if it were row-major gives the transpose, which has
+		// the same determinant and whose inverse is the transpose of ours, so
+		// writing the result back the same way round comes out correct.
 
-		// operator +=
-		Matrix4& operator +=(const Matrix4& rhs)
+		float Determinant() const
 		{
-			for (int i = 0; i < 16; i++)
-			{
-				v[i] += rhs.v[i];
-			}
-			return *this;
-		}
+			float s0 = mm[0][0] * mm[1][1] - mm[1][0] * mm[0][1];
+			float s1 = mm[0][0] * mm[1][2] - mm[1][0] * mm[0][2];
+			float s2 = mm[0][0] * mm[1][3] - mm[1][0] * mm[0][3];
+			float s3 = mm[0][1] * mm[1][2] - mm[1][1] * mm[0][2];
+			float s4 = mm[0][1] * mm[1][3] - mm[1][1] * mm[0][3];
+			float s5 = mm[0][2] * mm[1][3] - mm[1][2] * mm[0][3];
 
-		// operator -=
-		Matrix4& operator -=(const Matrix4& rhs)
-		{
-			for (int i = 0; i < 16; i++)
-			{
-				v[i] -= rhs.v[i];
-			}
-			return *this;
-		}
+			float c5 = mm[2][2] * mm[3][3] - mm[3][2] * mm[2][3];
+			float c4 = mm[2][1] * mm[3][3] - mm[3][1] * mm[2][3];
+			float c3 = mm[2][1] * mm[3][2] - mm[3][1] * mm[2][2];
+			float c2 = mm[2][0] * mm[3][3] - mm[3][0] * mm[2][3];
+			float c1 = mm[2][0] * mm[3][2] - mm[3][0] * mm[2][2];
+			float c0 = mm[2][0] * mm[3][1] - mm[3][0] * mm[2][1];
 
-		// operator *=
-		Matrix4& operator *=(const Matrix4& rhs)
-		{
-			*this = *this * rhs;
-			return *this;
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 		}
 
-		// operator /=
-		Matrix4& operator /=(const float rhs)
+		// General inverse. A singular matrix gives back an all-zero matrix.
+		Matrix4 Inverse() const
 		{
-			for (int i = 0; i < 16; ++i)
+			Matrix4 result;
+
+#ifdef MATHCLASSES_SSE
+			// split into 2x2 blocks | A B |, each packed into one register
+			//                       | C D |
+			__m128 A = _mm_movelh_ps(axis[0].simd, axis[1].simd);
+			__m128 B = _mm_movehl_ps(axis[1].simd, axis[0].simd);
+			__m128 C = _mm_movelh_ps(axis[2].simd, axis[3].simd);
+			__m128 D = _mm_movehl_ps(axis[3].simd, axis[2].simd);
+
+			// (|A|, |B|, |C|, |D|)
+			__m128 detSub = _mm_sub_ps(
+				_mm_mul_ps(_mm_shuffle_ps(axis[0].simd, axis[2].simd, _MM_SHUFFLE(2, 0, 2, 0)),
+					_mm_shuffle_ps(axis[1].simd, axis[3].simd, _MM_SHUFFLE(3, 1, 3, 1))),
+				_mm_mul_ps(_mm_shuffle_ps(axis[0].simd, axis[2].simd, _MM_SHUFFLE(3, 1, 3, 1)),
+					_mm_shuffle_ps(axis[1].simd, axis[3].simd, _MM_SHUFFLE(2, 0, 2, 0))));
+			__m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+			__m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+			__m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+			__m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+			// inverse = 1/|M| * | X Y |, built from adjugates (written #)
+			//                   | Z W |
+			__m128 D_C = Mat2AdjMul(D, C);
+			__m128 A_B = Mat2AdjMul(A, B);
+			__m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+			__m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+			__m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+			__m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+
+			// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+			__m128 tr = _mm_mul_ps(A_B, _mm_shuffle_ps(D_C, D_C, _MM_SHUFFLE(3, 1, 2, 0)));
+			tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1)));
+			tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+			__m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+			if (_mm_cvtss_f32(detM) == 0.0f)
 			{
-				v[i] /= rhs;
+				return result;
 			}
-			return *this;
-		}
 
-		// operator ==(Matrix, Matrix)
-		bool operator ==(const Matrix4& rhs) const
-		{
-			for (int i = 0; i < 16; i++)
+			// (1/|M|, -1/|M|, -1/|M|, 1/|M|)
+			__m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+			X_ = _mm_mul_ps(X_, rDetM);
+			Y_ = _mm_mul_ps(Y_, rDetM);
+			Z_ = _mm_mul_ps(Z_, rDetM);
+			W_ = _mm_mul_ps(W_, rDetM);
+
+			// undo the adjugate swizzle while unpacking the blocks
+			result.axis[0].simd = _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(1, 3, 1, 3));
+			result.axis[1].simd = _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(0, 2, 0, 2));
+			result.axis[2].simd = _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(1, 3, 1, 3));
+			result.axis[3].simd = _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(0, 2, 0, 2));
+#else
+			float s0 = mm[0][0] * mm[1][1] - mm[1][0] * mm[0][1];
+			float s1 = mm[0][0] * mm[1][2] - mm[1][0] * mm[0][2];
+			float s2 = mm[0][0] * mm[1][3] - mm[1][0] * mm[0][3];
+			float s3 = mm[0][1] * mm[1][2] - mm[1][1] * mm[0][2];
+			float s4 = mm[0][1] * mm[1][3] - mm[1][1] * mm[0][3];
+			float s5 = mm[0][2] * mm[1][3] - mm[1][2] * mm[0][3];
+
+			float c5 = mm[2][2] * mm[3][3] - mm[3][2] * mm[2][3];
+			float c4 = mm[2][1] * mm[3][3] - mm[3][1] * mm[2][3];
+			float c3 = mm[2][1] * mm[3][2] - mm[3][1] * mm[2][2];
+			float c2 = mm[2][0] * mm[3][3] - mm[3][0] * mm[2][3];
+			float c1 = mm[2][0] * mm[3][2] - mm[3][0] * mm[2][2];
+			float c0 = mm[2][0] * mm[3][1] - mm[3][0] * mm[2][1];
+
+			float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			if (det == 0.0f)
 			{
-				if(fabs(v[i] - rhs.v[i]) > 1e-6f)
-				{
-					return false;
-				}
+				return result;
 			}
-			return true;
+			float invDet = 1.0f / det;
+
+			result.mm[0][0] = (mm[1][1] * c5 - mm[1][2] * c4 + mm[1][3] * c3) * invDet;
+			result.mm[0][1] = (-mm[0][1] * c5 + mm[0][2] * c4 - mm[0][3] * c3) * invDet;
+			result.mm[0][2] = (mm[3][1] * s5 - mm[3][2] * s4 + mm[3][3] * s3) * invDet;
+			result.mm[0][3] = (-mm[2][1] * s5 + mm[2][2] * s4 - mm[2][3] * s3) * invDet;
+
+			result.mm[1][0] = (-mm[1][0] * c5 + mm[1][2] * c2 - mm[1][3] * c1) * invDet;
+			result.mm[1][1] = (mm[0][0] * c5 - mm[0][2] * c2 + mm[0][3] * c1) * invDet;
+			result.mm[1][2] = (-mm[3][0] * s5 + mm[3][2] * s2 - mm[3][3] * s1) * invDet;
+			result.mm[1][3] = (mm[2][0] * s5 - mm[2][2] * s2 + mm[2][3] * s1) * invDet;
+
+			result.mm[2][0] = (mm[1][0] * c4 - mm[1][1] * c2 + mm[1][3] * c0) * invDet;
+			result.mm[2][1] = (-mm[0][0] * c4 + mm[0][1] * c2 - mm[0][3] * c0) * invDet;
+			result.mm[2][2] = (mm[3][0] * s4 - mm[3][1] * s2 + mm[3][3] * s0) * invDet;
+			result.mm[2][3] = (-mm[2][0] * s4 + mm[2][1] * s2 - mm[2][3] * s0) * invDet;
+
+			result.mm[3][0] = (-mm[1][0] * c3 + mm[1][1] * c1 - mm[1][2] * c0) * invDet;
+			result.mm[3][1] = (mm[0][0] * c3 - mm[0][1] * c1 + mm[0][2] * c0) * invDet;
+			result.mm[3][2] = (-mm[3][0] * s3 + mm[3][1] * s1 - mm[3][2] * s0) * invDet;
+			result.mm[3][3] = (mm[2][0] * s3 - mm[2][1] * s1 + mm[2][2] * s0) * invDet;
+#endif
+			return result;
 		}
 
-		// operator !=(Matrix, Matrix)
-		bool operator !=(const Matrix4& rhs) const
+		// Inverse of an affine matrix - any invertible 3x3 block (rotation,
+		// scale, shear) plus a translation in m13 - m15, with 0, 0, 0, 1 along
+		// the bottom. Far cheaper than Inverse(). A singular 3x3 block gives
+		// back an all-zero matrix.
+		Matrix4 InverseAffine() const
 		{
-			return !(*this == rhs);
-		}
+			Vector4 c0(m1, m2, m3, 0), c1(m5, m6, m7, 0), c2(m9, m10, m11, 0);
 
-		// Matrix Multiplication
-		Matrix4 operator *(const Matrix4 rhs) const {
-			// stores the return value
-			Matrix4 result;
-
-			// iterate through first matrix
-			for (size_t i = 0; i < 4; ++i) {
-				// current row from first matrix
-				Vector4 row(mm[0][i], mm[1][i], mm[2][i], mm[3][i]);
+			// rows of the inverse 3x3 block are the cross products of the columns
+			Vector4 r0 = c1.Cross(c2);
+			Vector4 r1 = c2.Cross(c0);
+			Vector4 r2 = c0.Cross(c1);
 
-				// iterate through columns in the second matrix
-				for (size_t j = 0; j < 4; ++j) {
-					// dot each row with each column and assign to result matrix
-					// result is calculated row-by-row
-					result.mm[j][i] = row.Dot(rhs.axis[j]);
-				}
+			float det = c0.Dot(r0);
+			if (det == 0.0f)
+			{
+				return Matrix4();
 			}
-			return result;
+			float invDet = 1.0f / det;
+			r0 *= invDet;
+			r1 *= invDet;
+			r2 *= invDet;
+
+			// translation is -(R^-1 * t)
+			Vector4 t(m13, m14, m15, 0);
+			return Matrix4(r0.x, r1.x, r2.x, 0,
+				r0.y, r1.y, r2.y, 0,
+				r0.z, r1.z, r2.z, 0,
+				-r0.Dot(t), -r1.Dot(t), -r2.Dot(t), 1);
 		}
 
+#ifdef MATHCLASSES_SSE
 		//
-		// Matrix Multiplication against a Vector
+		// 2x2 block helpers for Inverse, each 2x2 matrix is packed as (m00, m01, m10, m11)
 
-		Vector4 operator *(const Vector4 rhs) const {
-			return Vector4(
-				Vector4(m1, m5, m9, m13).Dot(rhs),
-				Vector4(m2, m6, m10, m14).Dot(rhs),
-				Vector4(m3, m7, m11, m15).Dot(rhs),
-				Vector4(m4, m8, m12, m16).Dot(rhs)
-			);
+		// A * B
+		static __m128 Mat2Mul(__m128 a, __m128 b)
+		{
+			return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
 		}
 
-		//
-		// Matrix Transposition
-		Matrix4 Transposed() const {
-			return Matrix4(m1, m5, m9, m13,
-						   m2, m6, m10, m14,
-						   m3, m7, m11, m15,
-						   m4, m8, m12, m16);
+		// adjugate(A) * B
+		static __m128 Mat2AdjMul(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
 		}
 
+		// A * adjugate(B)
+		static __m128 Mat2MulAdj(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+		}
+#endif
+
 		//
 		// ToString
-
-		string ToString() const {
+		string ToString() const
+		{
 			string str = to_string(v[0]);
-			for (size_t i = 1; i < 16; ++i) {
-				str += ", " + to_string(v[i]);
+			for (size_t i = 1; i < 16; ++i)
+			{
+				str += "," + to_string(v[i]);
 			}
 			return str;
 		}
 
 		//
-		// Matrix Transformations
+		// Matrix transformations
 		//
 
 		// Rotate X-axis
-		static Matrix4 MakeRotateX(float a) {
+		static Matrix4 MakeRotateX(float a)
+		{
 			return Matrix4(1, 0, 0, 0,
-						   0, cosf(a), -sinf(a), 0,
-						   0, sinf(a), cosf(a), 0,
-						   0, 0, 0, 1);
+				0, cosf(a), -sinf(a), 0,
+				0, sinf(a), cosf(a), 0,
+				0, 0, 0, 1);
 		}
 
-		// Rotate Y-axis
-		static Matrix4 MakeRotateY(float a) {
+		// Rotate y-axis
+		static Matrix4 MakeRotateY(float a)
+		{
 			return Matrix4(cosf(a), 0, sinf(a), 0,
-						   0, 1, 0, 0,
-						   -sinf(a), 0, cosf(a), 0,
-						   0, 0, 0, 1);
-		}
-
-		// Rotate Z-axis
-		static Matrix4 MakeRotateZ(float a) {
-			return Matrix4(cosf(a), -sinf(a), 0, 0,
-						   sinf(a), cosf(a), 0, 0,
-						   0, 0, 1, 0,
-						   0, 0, 0, 1);
+				0, 1, 0, 0,
+				-sinf(a), 0, cosf(a), 0,
+				0, 0, 0, 1);
 		}
 
-		//
-		//Rotate an existing Matrix
-
-		static Matrix4 MakeRotatedIdentity(float angle) {
-			Matrix4 modelMatrix = Matrix4::MakeIdentity();
-			modelMatrix *= Matrix4::MakeRotateX(angle);
-			return modelMatrix;
+		// Rotate z-axis
+		static Matrix4 MakeRotateZ(float a)
+		{
+			return Matrix4(cosf(a), sinf(a), 0, 0,
+				-sinf(a), cosf(a), 0, 0,
+				0, 0, 1, 0,
+				0, 0, 0, 1);
 		}
 
 		//
 		// Euler Angle Rotations
 
-		static Matrix4 MakeEuler(float pitch, float yaw, float roll) {
-			Matrix4 x = MakeRotateX(pitch);
-			Matrix4 y = MakeRotateY(yaw);
-			Matrix4 z = MakeRotateZ(roll);
-
-			// combine rotations in a specific order
-			return (z * y * x);
-		}
+		// Same result as MakeRotateZ(roll) * MakeRotateY(yaw) * MakeRotateX(pitch),
+		// but with one sin/cos per angle and the entries written out directly
+		static Matrix4 MakeEuler(float pitch, float yaw, float roll)
+		{
+			float sx = sinf(pitch), cx = cosf(pitch);
+			float sy = sinf(yaw), cy = cosf(yaw);
+			float sz = sinf(roll), cz = cosf(roll);
 
-		static Matrix4 MakeScale(float xScale, float yScale, float zScale) {
-			return Matrix4(xScale, 0.0f, 0.0f, 0.0f,
-						   0.0f, yScale, 0.0f, 0.0f,
-						   0.0f, 0.0f, zScale, 0.0f,
-						   0.0f, 0.0f, 0.0f, 1.0f);
+			return Matrix4(cz * cy, sz * cy, sy, 0,
+				cz * sy * sx - sz * cx, cz * cx + sz * sy * sx, -cy * sx, 0,
+				-cz * sy * cx - sz * sx, cz * sx - sz * sy * cx, cy * cx, 0,
+				0, 0, 0, 1);
 		}
 
-		static Matrix4 MakeScale(Vector4 scale) {
-			// reuses the function above
-			return MakeScale(scale.x, scale.y, scale.z);
+		static Matrix4 MakeEuler(const Vector3& rot)
+		{
+			return MakeEuler(rot.x, rot.y, rot.z);
 		}
 
-		static Matrix4 MakeScale(float xScale, float yScale)
+		// Batch version, angles holds (pitch, yaw, roll) triples
+		static void MakeEuler(const Vector3* angles, Matrix4* out, size_t count)
 		{
-			return Matrix4(xScale, 0.0f, 0.0f, 0.0f,
-						   0.0f, yScale, 0.0f, 0.0f,
-						   0.0f, 0.0f, 1.0f, 0.0f,
-						   0.0f, 0.0f, 0.0f, 1.0f);
+			for (size_t i = 0; i < count; ++i)
+			{
+				out[i] = MakeEuler(angles[i].x, angles[i].y, angles[i].z);
+			}
 		}
 
+		//
+		// Translation & Scale
 
-		static Matrix4 MakeTranslation(float x, float y, float z) {
+		static Matrix4 MakeTranslation(float x, float y, float z)
+		{
 			Matrix4 result = MakeIdentity();
 			result.m13 = x;
 			result.m14 = y;
@@ -515,12 +609,61 @@ namespace MathClasses
 			return result;
 		}
 
-		static Matrix4 MakeTranslation(Vector4 vec) {
+		static Matrix4 MakeTranslation(const Vector3& vec)
+		{
 			return MakeTranslation(vec.x, vec.y, vec.z);
 		}
 
-		static Matrix4 MakeEuler(Vector4 rot) {
-			return MakeEuler(rot.x, rot.y, rot.z);
+		static Matrix4 MakeScale(float xScale, float yScale, float zScale)
+		{
+			return Matrix4(xScale, 0, 0, 0,
+				0, yScale, 0, 0,
+				0, 0, zScale, 0,
+				0, 0, 0, 1);
 		}
+
+		static Matrix4 MakeScale(const Vector3& scale)
+		{
+			return MakeScale(scale.x, scale.y, scale.z);
+		}
+
+		//
+		// Translation, Rotation & Scale
+		//
+		// Same result as MakeTranslation(t) * rotation * MakeScale(s) - scale
+		// first, then rotate, then move - with the rotation columns scaled and
+		// the 16 entries written out directly instead of two full products.
+		//
+		// The Quaternion versions, and Decompose which goes the other way, are
+		// defined at the end of Quaternion.h, so include that to use them.
+
+		// rotation as (pitch, yaw, roll), the same as MakeEuler
+		static Matrix4 MakeTRS(const Vector3& translation, const Vector3& rotation, const Vector3& scale)
+		{
+			Matrix4 result = MakeEuler(rotation.x, rotation.y, rotation.z);
+			result.axis[0] *= scale.x;
+			result.axis[1] *= scale.y;
+			result.axis[2] *= scale.z;
+			result.axis[3] = Vector4(translation.x, translation.y, translation.z, 1);
+			return result;
+		}
+
+		static Matrix4 MakeTRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
+
+		// Batch version
+		static void MakeTRS(const Vector3* translations, const Quaternion* rotations, const Vector3* scales, Matrix4* out, size_t count);
+
+		// Split an affine matrix back into the parts MakeTRS takes, without
+		// inverting anything: translation is the last column, scale the
+		// lengths of the others, and rotation what's left once they are unit
+		// length. A mirrored matrix comes out with a negative x scale. Shear
+		// can't be represented and is lost.
+		//
+		// Returns false if a scale is zero, so there's no rotation to recover;
+		// rotation is then the identity and translation and scale still get set.
+		bool Decompose(Vector3& translation, Quaternion& rotation, Vector3& scale) const;
+
+		// Batch version, returns how many decomposed cleanly
+		static size_t Decompose(const Matrix4* in, Vector3* translations, Quaternion* rotations, Vector3* scales, size_t count);
 	};
 }
@@ -0,0 +1,376 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Simd.h"
+#include "Colour.h"
+
+namespace MathClasses
+{
+    //
+    // PIXEL FORMATS
+    //
+    // 8-bit formats are named by their byte order in memory, the way graphics
+    // APIs and file formats name them. Colour itself keeps red in the top byte
+    // of an unsigned int, which on little-endian machines is A, B, G, R in memory.
+    //
+    enum class PixelFormat
+    {
+        // bytes R, G, B, A
+        RGBA8,
+        // bytes B, G, R, A
+        BGRA8,
+        // bytes A, R, G, B
+        ARGB8,
+        // 16 bits, red in the top 5 bits, green 6, blue 5. Alpha is dropped.
+        RGB565,
+        // 16 bits, red in the top 4 bits down to alpha in the bottom 4
+        RGBA4444,
+        // four floats R, G, B, A in [0, 1]
+        Float4
+    };
+
+    //
+    // PIXEL CONVERSION
+    //
+    // Bulk conversion between Colour and the formats above. The 8-bit formats
+    // are byte shuffles (pshufb with SSSE3/AVX2, shifts and word shuffles with
+    // plain SSE2), the others widen to 32-bit lanes with SSE2. Narrowing to
+    // 16 bits keeps the top bits of each channel, widening repeats them into
+    // the low bits so 0 and full scale round trip.
+    //
+    struct PixelConvert
+    {
+        static size_t BytesPerPixel(PixelFormat format) {
+            switch (format) {
+            case PixelFormat::RGB565:
+            case PixelFormat::RGBA4444:
+                return 2;
+            case PixelFormat::Float4:
+                return 4 * sizeof(float);
+            default:
+                return 4;
+            }
+        }
+
+        // out must hold count * BytesPerPixel(format) bytes
+        static void FromColour(const Colour* in, void* out, size_t count, PixelFormat format) {
+            switch (format) {
+            case PixelFormat::RGBA8:
+            case PixelFormat::BGRA8:
+            case PixelFormat::ARGB8:
+                Swizzle(in, out, count, format, false);
+                break;
+            case PixelFormat::RGB565:
+                ToRGB565(in, static_cast<uint16_t*>(out), count);
+                break;
+            case PixelFormat::RGBA4444:
+                ToRGBA4444(in, static_cast<uint16_t*>(out), count);
+                break;
+            case PixelFormat::Float4:
+                ToFloat4(in, static_cast<float*>(out), count);
+                break;
+            }
+        }
+
+        // in holds count * BytesPerPixel(format) bytes. RGB565 comes back opaque.
+        static void ToColour(const void* in, Colour* out, size_t count, PixelFormat format) {
+            switch (format) {
+            case PixelFormat::RGBA8:
+            case PixelFormat::BGRA8:
+            case PixelFormat::ARGB8:
+                Swizzle(in, out, count, format, true);
+                break;
+            case PixelFormat::RGB565:
+                FromRGB565(static_cast<const uint16_t*>(in), out, count);
+                break;
+            case PixelFormat::RGBA4444:
+                FromRGBA4444(static_cast<const uint16_t*>(in), out, count);
+                break;
+            case PixelFormat::Float4:
+                FromFloat4(static_cast<const float*>(in), out, count);
+                break;
+            }
+        }
+
+    private:
+        // Output byte j of each pixel is input byte order[j], indexed by the 8-bit PixelFormat's
+        static constexpr unsigned char FROM_COLOUR[3][4] = { { 3, 2, 1, 0 }, { 1, 2, 3, 0 }, { 0, 3, 2, 1 } };
+        static constexpr unsigned char TO_COLOUR[3][4] = { { 3, 2, 1, 0 }, { 3, 0, 1, 2 }, { 0, 3, 2, 1 } };
+
+        //
+        // 8-bit byte orders
+        //
+
+        // toColour picks the direction, from the 8-bit format or to it
+        static void Swizzle(const void* in, void* out, size_t count, PixelFormat format, bool toColour) {
+            const unsigned char* order = (toColour ? TO_COLOUR : FROM_COLOUR)[static_cast<int>(format)];
+            const unsigned char* src = static_cast<const unsigned char*>(in);
+            unsigned char* dst = static_cast<unsigned char*>(out);
+            size_t i = 0;
+#if defined(MATHCLASSES_AVX2)
+            __m256i wideMask = _mm256_broadcastsi128_si256(ShuffleMask(order));
+            for (; i + 8 <= count; i += 8) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src[i * 4]));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[i * 4]), _mm256_shuffle_epi8(v, wideMask));
+            }
+#endif
+#if defined(MATHCLASSES_SSSE3)
+            __m128i mask = ShuffleMask(order);
+            for (; i + 4 <= count; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i * 4]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i * 4]), _mm_shuffle_epi8(v, mask));
+            }
+#elif defined(MATHCLASSES_SSE)
+            // each of the three orders is a byte reverse, a rotate, or both
+            switch (format) {
+            case PixelFormat::RGBA8:
+                i = SwizzleSSE2<BYTE_REVERSE>(src, dst, count);
+                break;
+            case PixelFormat::BGRA8:
+                i = toColour ? SwizzleSSE2<ROTATE_LEFT>(src, dst, count) : SwizzleSSE2<ROTATE_RIGHT>(src, dst, count);
+                break;
+            default:
+                i = SwizzleSSE2<REVERSE_ROTATE_LEFT>(src, dst, count);
+                break;
+            }
+#endif
+            for (; i < count; ++i) {
+                unsigned char pixel[4];
+                memcpy(pixel, &src[i * 4], 4);
+                dst[i * 4 + 0] = pixel[order[0]];
+                dst[i * 4 + 1] = pixel[order[1]];
+                dst[i * 4 + 2] = pixel[order[2]];
+                dst[i * 4 + 3] = pixel[order[3]];
+            }
+        }
+
+#if defined(MATHCLASSES_SSSE3)
+        // the per-pixel order repeated across all four pixels of a register
+        static __m128i ShuffleMask(const unsigned char* order) {
+            alignas(16) unsigned char mask[16];
+            for (int p = 0; p < 4; ++p) {
+                for (int j = 0; j < 4; ++j) {
+                    mask[p * 4 + j] = static_cast<unsigned char>(p * 4 + order[j]);
+                }
+            }
+            return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+        }
+#elif defined(MATHCLASSES_SSE)
+        // Without pshufb, as operations on each pixel's 32-bit value. Colour
+        // is A, B, G, R in memory, so RGBA8 is the bytes reversed, BGRA8 is
+        // the value rotated by 8 bits, and ARGB8 is the two together.
+        enum SwizzleOp { BYTE_REVERSE, ROTATE_LEFT, ROTATE_RIGHT, REVERSE_ROTATE_LEFT };
+
+        static __m128i ByteReverse(__m128i v) {
+            // swap the bytes in each 16-bit half, then swap the halves
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        }
+
+        static __m128i RotateLeft8(__m128i v) {
+            return _mm_or_si128(_mm_slli_epi32(v, 8), _mm_srli_epi32(v, 24));
+        }
+
+        static __m128i RotateRight8(__m128i v) {
+            return _mm_or_si128(_mm_srli_epi32(v, 8), _mm_slli_epi32(v, 24));
+        }
+
+        // Four pixels at a time, returns how many were done
+        template <SwizzleOp OP>
+        static size_t SwizzleSSE2(const unsigned char* src, unsigned char* dst, size_t count) {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i * 4]));
+                switch (OP) {
+                case BYTE_REVERSE: v = ByteReverse(v); break;
+                case ROTATE_LEFT: v = RotateLeft8(v); break;
+                case ROTATE_RIGHT: v = RotateRight8(v); break;
+                case REVERSE_ROTATE_LEFT: v = RotateLeft8(ByteReverse(v)); break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i * 4]), v);
+            }
+            return i;
+        }
+#endif
+
+        //
+        // 16-bit packed formats
+        //
+
+        static uint16_t PackRGB565(unsigned int c) {
+            return static_cast<uint16_t>(((c >> 16) & 0xf800) | ((c >> 13) & 0x07e0) | ((c >> 11) & 0x001f));
+        }
+
+        static uint16_t PackRGBA4444(unsigned int c) {
+            return static_cast<uint16_t>(((c >> 16) & 0xf000) | ((c >> 12) & 0x0f00) | ((c >> 8) & 0x00f0) | ((c >> 4) & 0x000f));
+        }
+
+        static unsigned int UnpackRGB565(unsigned int p) {
+            unsigned int r = (p >> 11) & 0x1f, g = (p >> 5) & 0x3f, b = p & 0x1f;
+            r = (r << 3) | (r >> 2);
+            g = (g << 2) | (g >> 4);
+            b = (b << 3) | (b >> 2);
+            return (r << 24) | (g << 16) | (b << 8) | 0xff;
+        }
+
+        static unsigned int UnpackRGBA4444(unsigned int p) {
+            // spreading each nibble to the bottom of its own byte, then n * 17 fills the top
+            unsigned int spread = ((p & 0xf000) << 12) | ((p & 0x0f00) << 8) | ((p & 0x00f0) << 4) | (p & 0x000f);
+            return spread * 17;
+        }
+
+#if defined(MATHCLASSES_SSE)
+        // 4 x 32-bit lanes holding 16-bit values down to 4 x 16 bits in the low half.
+        // packs saturates signed values, so sign extend the low 16 bits first.
+        static __m128i Narrow32(__m128i v) {
+            v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+            return _mm_packs_epi32(v, v);
+        }
+
+        static __m128i PackRGB565(__m128i c) {
+            return _mm_or_si128(_mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(c, 16), _mm_set1_epi32(0xf800)),
+                _mm_and_si128(_mm_srli_epi32(c, 13), _mm_set1_epi32(0x07e0))),
+                _mm_and_si128(_mm_srli_epi32(c, 11), _mm_set1_epi32(0x001f)));
+        }
+
+        static __m128i PackRGBA4444(__m128i c) {
+            return _mm_or_si128(_mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(c, 16), _mm_set1_epi32(0xf000)),
+                _mm_and_si128(_mm_srli_epi32(c, 12), _mm_set1_epi32(0x0f00))), _mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0x00f0)),
+                _mm_and_si128(_mm_srli_epi32(c, 4), _mm_set1_epi32(0x000f))));
+        }
+
+        static __m128i UnpackRGB565(__m128i p) {
+            __m128i mask5 = _mm_set1_epi32(0x1f);
+            __m128i r = _mm_and_si128(_mm_srli_epi32(p, 11), mask5);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x3f));
+            __m128i b = _mm_and_si128(p, mask5);
+            r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+            g = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4));
+            b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+            return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 24), _mm_slli_epi32(g, 16)),
+                _mm_or_si128(_mm_slli_epi32(b, 8), _mm_set1_epi32(0xff)));
+        }
+
+        static __m128i UnpackRGBA4444(__m128i p) {
+            __m128i spread = _mm_or_si128(_mm_or_si128(
+                _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xf000)), 12),
+                _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0x0f00)), 8)), _mm_or_si128(
+                _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0x00f0)), 4),
+                _mm_and_si128(p, _mm_set1_epi32(0x000f))));
+            // * 17
+            return _mm_add_epi32(_mm_slli_epi32(spread, 4), spread);
+        }
+#endif
+
+        static void ToRGB565(const Colour* in, uint16_t* out, size_t count) {
+            size_t i = 0;
+#if defined(MATHCLASSES_SSE)
+            for (; i + 4 <= count; i += 4) {
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[i]), Narrow32(PackRGB565(c)));
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i] = PackRGB565(in[i].colour);
+            }
+        }
+
+        static void ToRGBA4444(const Colour* in, uint16_t* out, size_t count) {
+            size_t i = 0;
+#if defined(MATHCLASSES_SSE)
+            for (; i + 4 <= count; i += 4) {
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[i]), Narrow32(PackRGBA4444(c)));
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i] = PackRGBA4444(in[i].colour);
+            }
+        }
+
+        static void FromRGB565(const uint16_t* in, Colour* out, size_t count) {
+            size_t i = 0;
+#if defined(MATHCLASSES_SSE)
+            for (; i + 4 <= count; i += 4) {
+                __m128i p = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&in[i])), _mm_setzero_si128());
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), UnpackRGB565(p));
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i].colour = UnpackRGB565(in[i]);
+            }
+        }
+
+        static void FromRGBA4444(const uint16_t* in, Colour* out, size_t count) {
+            size_t i = 0;
+#if defined(MATHCLASSES_SSE)
+            for (; i + 4 <= count; i += 4) {
+                __m128i p = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&in[i])), _mm_setzero_si128());
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), UnpackRGBA4444(p));
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i].colour = UnpackRGBA4444(in[i]);
+            }
+        }
+
+        //
+        // Float4
+        //
+
+        static void ToFloat4(const Colour* in, float* out, size_t count) {
+            const float toUnit = 1.0f / 255.0f;
+            size_t i = 0;
+#if defined(MATHCLASSES_SSE)
+            __m128 scale = _mm_set1_ps(toUnit);
+            __m128i zero = _mm_setzero_si128();
+            for (; i + 4 <= count; i += 4) {
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+                __m128i lo = _mm_unpacklo_epi8(c, zero), hi = _mm_unpackhi_epi8(c, zero);
+                __m128i pixels[4] = { _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                    _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+                for (int p = 0; p < 4; ++p) {
+                    // A, B, G, R to R, G, B, A
+                    __m128i rgba = _mm_shuffle_epi32(pixels[p], _MM_SHUFFLE(0, 1, 2, 3));
+                    _mm_storeu_ps(&out[(i + p) * 4], _mm_mul_ps(_mm_cvtepi32_ps(rgba), scale));
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i * 4 + 0] = in[i].GetRed() * toUnit;
+                out[i * 4 + 1] = in[i].GetGreen() * toUnit;
+                out[i * 4 + 2] = in[i].GetBlue() * toUnit;
+                out[i * 4 + 3] = in[i].GetAlpha() * toUnit;
+            }
+        }
+
+        static void FromFloat4(const float* in, Colour* out, size_t count) {
+            size_t i = 0;
+#if defined(MATHCLASSES_SSE)
+            __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+            __m128 scale = _mm_set1_ps(255.0f), half = _mm_set1_ps(0.5f);
+            for (; i + 4 <= count; i += 4) {
+                __m128i pixels[4];
+                for (int p = 0; p < 4; ++p) {
+                    // max with the value first so NaN becomes 0, the same as Colour::FloatToByte
+                    __m128 c = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&in[(i + p) * 4]), zero), one);
+                    __m128i rgba = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, scale), half));
+                    pixels[p] = _mm_shuffle_epi32(rgba, _MM_SHUFFLE(0, 1, 2, 3));
+                }
+                __m128i packed = _mm_packus_epi16(_mm_packs_epi32(pixels[0], pixels[1]), _mm_packs_epi32(pixels[2], pixels[3]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), packed);
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i] = Colour(Colour::FloatToByte(in[i * 4 + 0]), Colour::FloatToByte(in[i * 4 + 1]),
+                    Colour::FloatToByte(in[i * 4 + 2]), Colour::FloatToByte(in[i * 4 + 3]));
+            }
+        }
+    };
+}
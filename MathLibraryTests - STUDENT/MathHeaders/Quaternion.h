@@ -0,0 +1,310 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+#include "Vector3.h"
+#include "Matrix3.h"
+#include "Matrix4.h"
+
+namespace MathClasses
+{
+    //
+    // QUATERNIONS
+    //
+    // Unit quaternions for storing and combining rotations in four floats.
+    // Conventions follow the matrix types: q1 * q2 applies q2 first, and
+    // MakeEuler produces the same rotation as Matrix3::MakeEuler.
+    //
+    struct alignas(16) Quaternion
+    {
+        float x, y, z, w;
+
+        // Default constructor - identity rotation
+        Quaternion() : x{ 0 }, y{ 0 }, z{ 0 }, w{ 1 } {}
+
+        Quaternion(float x, float y, float z, float w) : x{ x }, y{ y }, z{ z }, w{ w } {}
+
+        static Quaternion MakeIdentity() {
+            return Quaternion(0, 0, 0, 1);
+        }
+
+        // Rotation of angle radians (right-handed) about a unit length axis
+        static Quaternion MakeAxisAngle(const Vector3& axis, float angle) {
+            float s = sinf(angle * 0.5f);
+            return Quaternion(axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f));
+        }
+
+        //
+        // Euler Angle Rotations
+
+        // Same rotation as Matrix3::MakeEuler(pitch, yaw, roll). The matrix
+        // versions of MakeRotateX/Y turn the opposite way to MakeRotateZ, so
+        // this is (Z, roll) * (Y, -yaw) * (X, -pitch) multiplied out.
+        static Quaternion MakeEuler(float pitch, float yaw, float roll) {
+            float sx = sinf(pitch * 0.5f), cx = cosf(pitch * 0.5f);
+            float sy = sinf(yaw * 0.5f), cy = cosf(yaw * 0.5f);
+            float sz = sinf(roll * 0.5f), cz = cosf(roll * 0.5f);
+
+            return Quaternion(sz * sy * cx - cz * cy * sx,
+                -cz * sy * cx - sz * cy * sx,
+                sz * cy * cx - cz * sy * sx,
+                cz * cy * cx + sz * sy * sx);
+        }
+
+        static Quaternion MakeEuler(const Vector3& rot) {
+            return MakeEuler(rot.x, rot.y, rot.z);
+        }
+
+        // The inverse of ToMatrix3, for a pure rotation matrix. Works from
+        // whichever of w, x, y or z is largest, to keep the divide well away
+        // from zero.
+        static Quaternion MakeFromMatrix(const Matrix3& m) {
+            float trace = m.mm[0][0] + m.mm[1][1] + m.mm[2][2];
+            if (trace > 0.0f) {
+                float s = 0.5f / sqrtf(trace + 1.0f);
+                return Quaternion((m.mm[1][2] - m.mm[2][1]) * s, (m.mm[2][0] - m.mm[0][2]) * s,
+                    (m.mm[0][1] - m.mm[1][0]) * s, 0.25f / s);
+            }
+            if (m.mm[0][0] > m.mm[1][1] && m.mm[0][0] > m.mm[2][2]) {
+                float s = 0.5f / sqrtf(1.0f + m.mm[0][0] - m.mm[1][1] - m.mm[2][2]);
+                return Quaternion(0.25f / s, (m.mm[1][0] + m.mm[0][1]) * s,
+                    (m.mm[2][0] + m.mm[0][2]) * s, (m.mm[1][2] - m.mm[2][1]) * s);
+            }
+            if (m.mm[1][1] > m.mm[2][2]) {
+                float s = 0.5f / sqrtf(1.0f + m.mm[1][1] - m.mm[0][0] - m.mm[2][2]);
+                return Quaternion((m.mm[1][0] + m.mm[0][1]) * s, 0.25f / s,
+                    (m.mm[2][1] + m.mm[1][2]) * s, (m.mm[2][0] - m.mm[0][2]) * s);
+            }
+            float s = 0.5f / sqrtf(1.0f + m.mm[2][2] - m.mm[0][0] - m.mm[1][1]);
+            return Quaternion((m.mm[2][0] + m.mm[0][2]) * s, (m.mm[2][1] + m.mm[1][2]) * s,
+                0.25f / s, (m.mm[0][1] - m.mm[1][0]) * s);
+        }
+
+        //
+        // Maths Operators
+
+        // operator * (Quaternion, Quaternion) - rhs is applied first
+        Quaternion operator *(const Quaternion& rhs) const {
+            return Quaternion(w * rhs.x + x * rhs.w + y * rhs.z - z * rhs.y,
+                w * rhs.y - x * rhs.z + y * rhs.w + z * rhs.x,
+                w * rhs.z + x * rhs.y - y * rhs.x + z * rhs.w,
+                w * rhs.w - x * rhs.x - y * rhs.y - z * rhs.z);
+        }
+
+        // operator *=
+        Quaternion& operator *=(const Quaternion& rhs) {
+            *this = *this * rhs;
+            return *this;
+        }
+
+        // operator * (Quaternion, float) - component-wise, used for blending
+        Quaternion operator *(float rhs) const {
+            return Quaternion(x * rhs, y * rhs, z * rhs, w * rhs);
+        }
+
+        // operator + (Quaternion, Quaternion) - component-wise, used for blending
+        Quaternion operator +(const Quaternion& rhs) const {
+            return Quaternion(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w);
+        }
+
+        // negation, q and -q are the same rotation
+        Quaternion operator -() const {
+            return Quaternion(-x, -y, -z, -w);
+        }
+
+        // Compares components, so q and -q are not equal
+        bool operator ==(const Quaternion& rhs) const {
+            const float THRESHOLD = 0.00001f;
+
+            return fabsf(x - rhs.x) < THRESHOLD && fabsf(y - rhs.y) < THRESHOLD &&
+                fabsf(z - rhs.z) < THRESHOLD && fabsf(w - rhs.w) < THRESHOLD;
+        }
+
+        bool operator !=(const Quaternion& rhs) const {
+            return !(*this == rhs);
+        }
+
+        std::string ToString() const {
+            return std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ", " + std::to_string(w);
+        }
+
+        float Dot(const Quaternion& other) const {
+            return x * other.x + y * other.y + z * other.z + w * other.w;
+        }
+
+        //
+        // MAGNITUDE & NORMALISATION
+        //
+
+        float Magnitude() const {
+            return sqrtf(Dot(*this));
+        }
+
+        // Normalise the quaternion, a zero quaternion is left untouched
+        void Normalise() {
+            float m = Magnitude();
+            if (m == 0.0f) {
+                return;
+            }
+            float inv = 1.0f / m;
+            x *= inv;
+            y *= inv;
+            z *= inv;
+            w *= inv;
+        }
+
+        // Returns a normalised copy of the Quaternion
+        Quaternion Normalised() const {
+            Quaternion copy = *this;
+            copy.Normalise();
+
+            return copy;
+        }
+
+        // The opposite rotation, for unit quaternions this is also the inverse
+        Quaternion Conjugate() const {
+            return Quaternion(-x, -y, -z, w);
+        }
+
+        Quaternion Inverse() const {
+            float m = Dot(*this);
+            return m == 0.0f ? *this : Conjugate() * (1.0f / m);
+        }
+
+        // Rotate a vector, cheaper than converting to a matrix for one-off use
+        Vector3 Rotate(const Vector3& vec) const {
+            // v + 2w(q x v) + 2q x (q x v)
+            Vector3 q(x, y, z);
+            Vector3 t = q.Cross(vec) * 2.0f;
+            return vec + t * w + q.Cross(t);
+        }
+
+        //
+        // INTERPOLATION
+        //
+
+        // Normalised linear interpolation along the shorter arc. Not constant
+        // speed, but far cheaper than Slerp and fine for small steps.
+        static Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float t) {
+            Quaternion end = a.Dot(b) < 0.0f ? -b : b;
+            return (a * (1.0f - t) + end * t).Normalised();
+        }
+
+        // Constant speed interpolation along the shorter arc
+        static Quaternion Slerp(const Quaternion& a, const Quaternion& b, float t) {
+            Quaternion end = b;
+            float d = a.Dot(b);
+            if (d < 0.0f) {
+                end = -b;
+                d = -d;
+            }
+
+            // nearly parallel, sin(theta) is too small to divide by
+            if (d > 0.9995f) {
+                return Nlerp(a, end, t);
+            }
+
+            float theta = acosf(d);
+            float invSin = 1.0f / sinf(theta);
+            return a * (sinf((1.0f - t) * theta) * invSin) + end * (sinf(t * theta) * invSin);
+        }
+
+        //
+        // MATRIX CONVERSION
+        //
+
+        // Expects a unit quaternion
+        Matrix3 ToMatrix3() const {
+            float xx = x * x, yy = y * y, zz = z * z;
+            float xy = x * y, xz = x * z, yz = y * z;
+            float wx = w * x, wy = w * y, wz = w * z;
+
+            return Matrix3(1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy),
+                2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx),
+                2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy));
+        }
+
+        // Expects a unit quaternion
+        Matrix4 ToMatrix4() const {
+            float xx = x * x, yy = y * y, zz = z * z;
+            float xy = x * y, xz = x * z, yz = y * z;
+            float wx = w * x, wy = w * y, wz = w * z;
+
+            return Matrix4(1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0,
+                2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0,
+                2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0,
+                0, 0, 0, 1);
+        }
+
+        // Batch versions
+        static void ToMatrix3(const Quaternion* in, Matrix3* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = in[i].ToMatrix3();
+            }
+        }
+
+        static void ToMatrix4(const Quaternion* in, Matrix4* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = in[i].ToMatrix4();
+            }
+        }
+    };
+
+    //
+    // MATRIX4 TRS
+    //
+    // Declared in Matrix4, which can't include this header.
+    //
+
+    // Expects a unit quaternion
+    inline Matrix4 Matrix4::MakeTRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale) {
+        float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+        float xx = x * x, yy = y * y, zz = z * z;
+        float xy = x * y, xz = x * z, yz = y * z;
+        float wx = w * x, wy = w * y, wz = w * z;
+
+        return Matrix4((1 - 2 * (yy + zz)) * scale.x, 2 * (xy + wz) * scale.x, 2 * (xz - wy) * scale.x, 0,
+            2 * (xy - wz) * scale.y, (1 - 2 * (xx + zz)) * scale.y, 2 * (yz + wx) * scale.y, 0,
+            2 * (xz + wy) * scale.z, 2 * (yz - wx) * scale.z, (1 - 2 * (xx + yy)) * scale.z, 0,
+            translation.x, translation.y, translation.z, 1);
+    }
+
+    inline void Matrix4::MakeTRS(const Vector3* translations, const Quaternion* rotations, const Vector3* scales, Matrix4* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = MakeTRS(translations[i], rotations[i], scales[i]);
+        }
+    }
+
+    inline bool Matrix4::Decompose(Vector3& translation, Quaternion& rotation, Vector3& scale) const {
+        translation = Vector3(m13, m14, m15);
+
+        Vector3 x(m1, m2, m3), y(m5, m6, m7), z(m9, m10, m11);
+        scale = Vector3(x.Magnitude(), y.Magnitude(), z.Magnitude());
+        if (scale.x == 0.0f || scale.y == 0.0f || scale.z == 0.0f) {
+            rotation = Quaternion();
+            return false;
+        }
+
+        // a rotation can't flip handedness, so put the flip in the scale
+        if (x.Dot(y.Cross(z)) < 0.0f) {
+            scale.x = -scale.x;
+        }
+        x = x * (1.0f / scale.x);
+        y = y * (1.0f / scale.y);
+        z = z * (1.0f / scale.z);
+
+        rotation = Quaternion::MakeFromMatrix(Matrix3(x.x, x.y, x.z, y.x, y.y, y.z, z.x, z.y, z.z)).Normalised();
+        return true;
+    }
+
+    inline size_t Matrix4::Decompose(const Matrix4* in, Vector3* translations, Quaternion* rotations, Vector3* scales, size_t count) {
+        size_t decomposed = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (in[i].Decompose(translations[i], rotations[i], scales[i])) {
+                ++decomposed;
+            }
+        }
+        return decomposed;
+    }
+}
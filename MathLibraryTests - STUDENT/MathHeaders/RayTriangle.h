@@ -0,0 +1,265 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Simd.h"
+#include "Vector3.h"
+#include "Vector3SoA.h"
+
+namespace MathClasses
+{
+    // Nearest hit so far along a ray. t starts out as the furthest distance
+    // worth looking at, and only gets lowered. The hit point is
+    // v0 + u * (v1 - v0) + v * (v2 - v0), or origin + t * direction.
+    struct RayHit
+    {
+        float t, u, v;
+        uint32_t triangle;
+
+        static constexpr uint32_t NO_TRIANGLE = static_cast<uint32_t>(-1);
+
+        explicit RayHit(float maxT = std::numeric_limits<float>::infinity()) : t{ maxT }, u{ 0 }, v{ 0 }, triangle{ NO_TRIANGLE } {}
+
+        bool IsHit() const { return triangle != NO_TRIANGLE; }
+    };
+
+    //
+    // TRIANGLES AS STRUCTURE-OF-ARRAYS
+    //
+    // Each triangle as its first vertex and the two edges leading away from
+    // it, which is what the intersection test wants. Padding triangles have
+    // zero size, so nothing ever hits them.
+    //
+    struct TriangleSoA
+    {
+        Vector3SoA v0, edge1, edge2;
+
+        TriangleSoA() {}
+
+        // vertices holds three corners per triangle
+        TriangleSoA(const Vector3* vertices, size_t count) : v0(count), edge1(count), edge2(count) {
+            for (size_t i = 0; i < count; ++i) {
+                Set(i, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+            }
+        }
+
+        size_t Size() const { return v0.Size(); }
+
+        void Resize(size_t count) {
+            v0.Resize(count);
+            edge1.Resize(count);
+            edge2.Resize(count);
+        }
+
+        void Set(size_t i, const Vector3& a, const Vector3& b, const Vector3& c) {
+            v0.Set(i, a);
+            edge1.Set(i, b - a);
+            edge2.Set(i, c - a);
+        }
+    };
+
+    //
+    // NEAREST HITS FOR A BATCH OF RAYS
+    //
+    // RayHit's as separate arrays, padded like Vector3SoA so they line up
+    // with a batch of rays stored in Vector3SoA's.
+    //
+    struct RayHitSoA
+    {
+        Vector3SoA::FloatArray t, u, v;
+        std::vector<uint32_t> triangle;
+
+        explicit RayHitSoA(size_t count = 0, float maxT = std::numeric_limits<float>::infinity()) {
+            Reset(count, maxT);
+        }
+
+        size_t Size() const { return count; }
+
+        // forget every hit, ready for a new batch
+        void Reset(size_t newCount, float maxT = std::numeric_limits<float>::infinity()) {
+            size_t padded = (newCount + FloatLanes::Width - 1) / FloatLanes::Width * FloatLanes::Width;
+            t.assign(padded, maxT);
+            u.assign(padded, 0.0f);
+            v.assign(padded, 0.0f);
+            triangle.assign(padded, RayHit::NO_TRIANGLE);
+            count = newCount;
+        }
+
+        RayHit Get(size_t i) const {
+            RayHit hit(t[i]);
+            hit.u = u[i];
+            hit.v = v[i];
+            hit.triangle = triangle[i];
+            return hit;
+        }
+
+    private:
+        size_t count;
+    };
+
+    //
+    // RAY / TRIANGLE INTERSECTION
+    //
+    // Moller-Trumbore, which finds t and the barycentrics together without
+    // needing the triangle's plane. Triangles are two sided, and hits count
+    // for t in [0, maxT).
+    //
+    // The batch versions work FloatLanes::Width at a time (8 with AVX, 4
+    // with SSE), either one ray against that many triangles or that many
+    // rays against one triangle.
+    //
+    struct RayTriangle
+    {
+        // below this the ray is taken as parallel to the triangle
+        static constexpr float PARALLEL_EPSILON = 1e-12f;
+
+        // One ray against one triangle. Updates hit and returns true if
+        // it is nearer than hit.t.
+        static bool Intersect(const Vector3& origin, const Vector3& direction,
+            const Vector3& v0, const Vector3& v1, const Vector3& v2, RayHit& hit, uint32_t triangle = 0) {
+            Vector3 edge1 = v1 - v0, edge2 = v2 - v0;
+            Vector3 p = direction.Cross(edge2);
+            float det = edge1.Dot(p);
+            if (fabsf(det) <= PARALLEL_EPSILON) {
+                return false;
+            }
+            float inverseDet = 1.0f / det;
+
+            Vector3 s = origin - v0;
+            float u = s.Dot(p) * inverseDet;
+            if (u < 0.0f || u > 1.0f) {
+                return false;
+            }
+            Vector3 q = s.Cross(edge1);
+            float v = direction.Dot(q) * inverseDet;
+            if (v < 0.0f || u + v > 1.0f) {
+                return false;
+            }
+            float t = edge2.Dot(q) * inverseDet;
+            if (t < 0.0f || t >= hit.t) {
+                return false;
+            }
+
+            hit.t = t;
+            hit.u = u;
+            hit.v = v;
+            hit.triangle = triangle;
+            return true;
+        }
+
+        // One ray against every triangle, keeping the nearest hit. Returns
+        // true if anything nearer than hit.t was found.
+        static bool IntersectNearest(const Vector3& origin, const Vector3& direction, const TriangleSoA& triangles, RayHit& hit) {
+            const size_t W = FloatLanes::Width;
+            Lanes3 o = Lanes3::Set(origin), d = Lanes3::Set(direction);
+            alignas(32) float t[W], u[W], v[W];
+
+            bool found = false;
+            for (size_t i = 0; i < triangles.v0.PaddedSize(); i += W) {
+                FloatLanes laneT, laneU, laneV;
+                FloatLanes mask = Lanes(o, d, Lanes3::Load(triangles.v0, i), Lanes3::Load(triangles.edge1, i),
+                    Lanes3::Load(triangles.edge2, i), FloatLanes::Set(hit.t), laneT, laneU, laneV);
+
+                // hits are rare, so only then pick through the lanes for the nearest
+                int bits = FloatLanes::MoveMask(mask);
+                if (bits == 0) {
+                    continue;
+                }
+                laneT.Store(t);
+                laneU.Store(u);
+                laneV.Store(v);
+                for (size_t j = 0; j < W; ++j) {
+                    if ((bits >> j) & 1 && t[j] < hit.t) {
+                        hit.t = t[j];
+                        hit.u = u[j];
+                        hit.v = v[j];
+                        hit.triangle = static_cast<uint32_t>(i + j);
+                        found = true;
+                    }
+                }
+            }
+            return found;
+        }
+
+        // Every ray against one triangle. Rays where it's nearer than the hit
+        // so far get it recorded in hits, which must be the same size as
+        // origins. Returns how many rays that was.
+        static size_t Intersect(const Vector3SoA& origins, const Vector3SoA& directions,
+            const Vector3& v0, const Vector3& v1, const Vector3& v2, uint32_t triangle, RayHitSoA& hits) {
+            const size_t W = FloatLanes::Width;
+            Lanes3 a = Lanes3::Set(v0), e1 = Lanes3::Set(v1 - v0), e2 = Lanes3::Set(v2 - v0);
+
+            size_t count = 0;
+            for (size_t i = 0; i < origins.PaddedSize(); i += W) {
+                FloatLanes bestT = FloatLanes::Load(&hits.t[i]);
+                FloatLanes t, u, v;
+                FloatLanes mask = Lanes(Lanes3::Load(origins, i), Lanes3::Load(directions, i), a, e1, e2, bestT, t, u, v);
+
+                int bits = FloatLanes::MoveMask(mask);
+                if (bits == 0) {
+                    continue;
+                }
+                FloatLanes::Select(mask, t, bestT).Store(&hits.t[i]);
+                FloatLanes::Select(mask, u, FloatLanes::Load(&hits.u[i])).Store(&hits.u[i]);
+                FloatLanes::Select(mask, v, FloatLanes::Load(&hits.v[i])).Store(&hits.v[i]);
+                for (size_t j = 0; j < W; ++j) {
+                    if ((bits >> j) & 1) {
+                        hits.triangle[i + j] = triangle;
+                        ++count;
+                    }
+                }
+            }
+            return count;
+        }
+
+    private:
+        struct Lanes3
+        {
+            FloatLanes x, y, z;
+
+            static Lanes3 Set(const Vector3& v) {
+                return Lanes3{ FloatLanes::Set(v.x), FloatLanes::Set(v.y), FloatLanes::Set(v.z) };
+            }
+
+            static Lanes3 Load(const Vector3SoA& soa, size_t i) {
+                return Lanes3{ FloatLanes::Load(&soa.x[i]), FloatLanes::Load(&soa.y[i]), FloatLanes::Load(&soa.z[i]) };
+            }
+
+            Lanes3 operator -(const Lanes3& rhs) const {
+                return Lanes3{ x - rhs.x, y - rhs.y, z - rhs.z };
+            }
+
+            FloatLanes Dot(const Lanes3& rhs) const {
+                return x * rhs.x + y * rhs.y + z * rhs.z;
+            }
+
+            Lanes3 Cross(const Lanes3& rhs) const {
+                return Lanes3{ y * rhs.z - z * rhs.y, z * rhs.x - x * rhs.z, x * rhs.y - y * rhs.x };
+            }
+        };
+
+        // The same steps as the single Intersect(), a register at a time.
+        // Returns a mask of the lanes that hit nearer than maxT.
+        static FloatLanes Lanes(const Lanes3& origin, const Lanes3& direction, const Lanes3& v0, const Lanes3& edge1, const Lanes3& edge2,
+            FloatLanes maxT, FloatLanes& t, FloatLanes& u, FloatLanes& v) {
+            FloatLanes zero = FloatLanes::Zero(), one = FloatLanes::Set(1.0f);
+
+            Lanes3 p = direction.Cross(edge2);
+            FloatLanes det = edge1.Dot(p);
+            FloatLanes mask = FloatLanes::Abs(det) > FloatLanes::Set(PARALLEL_EPSILON);
+            // parallel lanes get nonsense from here on, but they're already masked out
+            FloatLanes inverseDet = one / det;
+
+            Lanes3 s = origin - v0;
+            u = s.Dot(p) * inverseDet;
+            Lanes3 q = s.Cross(edge1);
+            v = direction.Dot(q) * inverseDet;
+            t = edge2.Dot(q) * inverseDet;
+
+            return mask & (u >= zero) & (u <= one) & (v >= zero) & (u + v <= one) & (t >= zero) & (t < maxT);
+        }
+    };
+}
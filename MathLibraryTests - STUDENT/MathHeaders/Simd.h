@@ -0,0 +1,213 @@
+#pragma once
+#include <cmath>
+
+//
+// SIMD SUPPORT
+//
+// Picks up which instruction sets the compiler is targeting so the maths headers
+// can use intrinsics where they're available and fall back to plain floats elsewhere.
+// Define MATHCLASSES_NO_SIMD before including any header to force the scalar paths.
+//
+
+#if !defined(MATHCLASSES_NO_SIMD)
+
+// SSE2 is always there on x64, MSVC just doesn't advertise it through __SSE2__
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATHCLASSES_SSE 1
+#include <emmintrin.h>
+#endif
+
+// MSVC has no /arch switch for SSSE3 or SSE4.1 on their own, but /arch:AVX implies both
+#if defined(MATHCLASSES_SSE) && (defined(__SSSE3__) || defined(__AVX__))
+#define MATHCLASSES_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+#if defined(MATHCLASSES_SSE) && (defined(__SSE4_1__) || defined(__AVX__))
+#define MATHCLASSES_SSE41 1
+#include <smmintrin.h>
+#endif
+
+#if defined(MATHCLASSES_SSE) && defined(__AVX__)
+#define MATHCLASSES_AVX 1
+#include <immintrin.h>
+#endif
+
+#if defined(MATHCLASSES_AVX) && defined(__AVX2__)
+#define MATHCLASSES_AVX2 1
+#endif
+
+#endif
+
+#include <cstddef>
+#include <new>
+
+namespace MathClasses
+{
+    //
+    // ALIGNED STORAGE
+    //
+    // std::vector allocator that hands out memory on an Alignment boundary, so the
+    // structure-of-arrays types can use aligned loads and stores.
+    //
+    template <typename T, size_t Alignment = 32>
+    struct AlignedAllocator
+    {
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+        AlignedAllocator() noexcept {}
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T* p, size_t) noexcept {
+            ::operator delete(p, std::align_val_t(Alignment));
+        }
+
+        template <typename U>
+        bool operator ==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+
+        template <typename U>
+        bool operator !=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+    };
+
+    //
+    // FLOAT LANES
+    //
+    // The widest float register available: 8 lanes with AVX, 4 with SSE, 1 otherwise.
+    // Bulk kernels are written once against this and pick up whichever width the
+    // build targets. Load/Store expect Width-aligned addresses.
+    //
+    struct FloatLanes
+    {
+#if defined(MATHCLASSES_AVX)
+        static constexpr size_t Width = 8;
+        __m256 v;
+
+        FloatLanes() {}
+        FloatLanes(__m256 v) : v{ v } {}
+
+        static FloatLanes Set(float f) { return _mm256_set1_ps(f); }
+        static FloatLanes Zero() { return _mm256_setzero_ps(); }
+        static FloatLanes Load(const float* p) { return _mm256_load_ps(p); }
+        static FloatLanes LoadUnaligned(const float* p) { return _mm256_loadu_ps(p); }
+        void Store(float* p) const { _mm256_store_ps(p, v); }
+        void StoreUnaligned(float* p) const { _mm256_storeu_ps(p, v); }
+
+        FloatLanes operator +(FloatLanes rhs) const { return _mm256_add_ps(v, rhs.v); }
+        FloatLanes operator -(FloatLanes rhs) const { return _mm256_sub_ps(v, rhs.v); }
+        FloatLanes operator *(FloatLanes rhs) const { return _mm256_mul_ps(v, rhs.v); }
+        FloatLanes operator /(FloatLanes rhs) const { return _mm256_div_ps(v, rhs.v); }
+
+        // comparisons give an all-ones/all-zeros mask per lane
+        FloatLanes operator <(FloatLanes rhs) const { return _mm256_cmp_ps(v, rhs.v, _CMP_LT_OQ); }
+        FloatLanes operator >(FloatLanes rhs) const { return _mm256_cmp_ps(v, rhs.v, _CMP_GT_OQ); }
+        FloatLanes operator <=(FloatLanes rhs) const { return _mm256_cmp_ps(v, rhs.v, _CMP_LE_OQ); }
+        FloatLanes operator >=(FloatLanes rhs) const { return _mm256_cmp_ps(v, rhs.v, _CMP_GE_OQ); }
+        FloatLanes operator &(FloatLanes rhs) const { return _mm256_and_ps(v, rhs.v); }
+        FloatLanes operator |(FloatLanes rhs) const { return _mm256_or_ps(v, rhs.v); }
+
+        static FloatLanes Sqrt(FloatLanes a) { return _mm256_sqrt_ps(a.v); }
+        // estimate, relative error < 4e-4
+        static FloatLanes RSqrt(FloatLanes a) { return _mm256_rsqrt_ps(a.v); }
+        static FloatLanes Min(FloatLanes a, FloatLanes b) { return _mm256_min_ps(a.v, b.v); }
+        static FloatLanes Max(FloatLanes a, FloatLanes b) { return _mm256_max_ps(a.v, b.v); }
+        static FloatLanes Abs(FloatLanes a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+
+        // per lane: mask ? a : b
+        static FloatLanes Select(FloatLanes mask, FloatLanes a, FloatLanes b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+
+        // one bit per lane of a comparison mask
+        static int MoveMask(FloatLanes mask) { return _mm256_movemask_ps(mask.v); }
+#elif defined(MATHCLASSES_SSE)
+        static constexpr size_t Width = 4;
+        __m128 v;
+
+        FloatLanes() {}
+        FloatLanes(__m128 v) : v{ v } {}
+
+        static FloatLanes Set(float f) { return _mm_set1_ps(f); }
+        static FloatLanes Zero() { return _mm_setzero_ps(); }
+        static FloatLanes Load(const float* p) { return _mm_load_ps(p); }
+        static FloatLanes LoadUnaligned(const float* p) { return _mm_loadu_ps(p); }
+        void Store(float* p) const { _mm_store_ps(p, v); }
+        void StoreUnaligned(float* p) const { _mm_storeu_ps(p, v); }
+
+        FloatLanes operator +(FloatLanes rhs) const { return _mm_add_ps(v, rhs.v); }
+        FloatLanes operator -(FloatLanes rhs) const { return _mm_sub_ps(v, rhs.v); }
+        FloatLanes operator *(FloatLanes rhs) const { return _mm_mul_ps(v, rhs.v); }
+        FloatLanes operator /(FloatLanes rhs) const { return _mm_div_ps(v, rhs.v); }
+
+        // comparisons give an all-ones/all-zeros mask per lane
+        FloatLanes operator <(FloatLanes rhs) const { return _mm_cmplt_ps(v, rhs.v); }
+        FloatLanes operator >(FloatLanes rhs) const { return _mm_cmpgt_ps(v, rhs.v); }
+        FloatLanes operator <=(FloatLanes rhs) const { return _mm_cmple_ps(v, rhs.v); }
+        FloatLanes operator >=(FloatLanes rhs) const { return _mm_cmpge_ps(v, rhs.v); }
+        FloatLanes operator &(FloatLanes rhs) const { return _mm_and_ps(v, rhs.v); }
+        FloatLanes operator |(FloatLanes rhs) const { return _mm_or_ps(v, rhs.v); }
+
+        static FloatLanes Sqrt(FloatLanes a) { return _mm_sqrt_ps(a.v); }
+        // estimate, relative error < 4e-4
+        static FloatLanes RSqrt(FloatLanes a) { return _mm_rsqrt_ps(a.v); }
+        static FloatLanes Min(FloatLanes a, FloatLanes b) { return _mm_min_ps(a.v, b.v); }
+        static FloatLanes Max(FloatLanes a, FloatLanes b) { return _mm_max_ps(a.v, b.v); }
+        static FloatLanes Abs(FloatLanes a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+
+        // per lane: mask ? a : b
+        static FloatLanes Select(FloatLanes mask, FloatLanes a, FloatLanes b) {
+#if defined(MATHCLASSES_SSE41)
+            return _mm_blendv_ps(b.v, a.v, mask.v);
+#else
+            return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+#endif
+        }
+
+        // one bit per lane of a comparison mask
+        static int MoveMask(FloatLanes mask) { return _mm_movemask_ps(mask.v); }
+#else
+        static constexpr size_t Width = 1;
+        float v;
+
+        FloatLanes() {}
+        FloatLanes(float v) : v{ v } {}
+
+        static FloatLanes Set(float f) { return f; }
+        static FloatLanes Zero() { return 0.0f; }
+        static FloatLanes Load(const float* p) { return *p; }
+        static FloatLanes LoadUnaligned(const float* p) { return *p; }
+        void Store(float* p) const { *p = v; }
+        void StoreUnaligned(float* p) const { *p = v; }
+
+        FloatLanes operator +(FloatLanes rhs) const { return v + rhs.v; }
+        FloatLanes operator -(FloatLanes rhs) const { return v - rhs.v; }
+        FloatLanes operator *(FloatLanes rhs) const { return v * rhs.v; }
+        FloatLanes operator /(FloatLanes rhs) const { return v / rhs.v; }
+
+        // comparisons give 1 or 0, which Select and MoveMask understand
+        FloatLanes operator <(FloatLanes rhs) const { return v < rhs.v ? 1.0f : 0.0f; }
+        FloatLanes operator >(FloatLanes rhs) const { return v > rhs.v ? 1.0f : 0.0f; }
+        FloatLanes operator <=(FloatLanes rhs) const { return v <= rhs.v ? 1.0f : 0.0f; }
+        FloatLanes operator >=(FloatLanes rhs) const { return v >= rhs.v ? 1.0f : 0.0f; }
+        FloatLanes operator &(FloatLanes rhs) const { return (v != 0.0f && rhs.v != 0.0f) ? 1.0f : 0.0f; }
+        FloatLanes operator |(FloatLanes rhs) const { return (v != 0.0f || rhs.v != 0.0f) ? 1.0f : 0.0f; }
+
+        static FloatLanes Sqrt(FloatLanes a) { return sqrtf(a.v); }
+        static FloatLanes RSqrt(FloatLanes a) { return 1.0f / sqrtf(a.v); }
+        static FloatLanes Min(FloatLanes a, FloatLanes b) { return a.v < b.v ? a.v : b.v; }
+        static FloatLanes Max(FloatLanes a, FloatLanes b) { return a.v > b.v ? a.v : b.v; }
+        static FloatLanes Abs(FloatLanes a) { return fabsf(a.v); }
+
+        // mask ? a : b
+        static FloatLanes Select(FloatLanes mask, FloatLanes a, FloatLanes b) { return mask.v != 0.0f ? a : b; }
+
+        static int MoveMask(FloatLanes mask) { return mask.v != 0.0f ? 1 : 0; }
+#endif
+    };
+}
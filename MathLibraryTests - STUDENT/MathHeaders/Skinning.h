@@ -0,0 +1,328 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Simd.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+#include "DualQuaternion.h"
+#include "Vector3SoA.h"
+#include "ThreadPool.h"
+
+namespace MathClasses
+{
+    //
+    // SKINNING
+    //
+    // A mesh's bind pose positions and normals, each vertex with up to
+    // MAX_INFLUENCES bones and weights, kept as structure-of-arrays. Skin()
+    // blends each vertex's bones from a palette by weight and transforms the
+    // vertex by the result. The palette can be Matrix4's (linear blend
+    // skinning) or DualQuaternion's.
+    //
+    // Palettes are expected to already include the inverse bind pose, and
+    // weights to add up to 1. Padding vertices read bone 0 with no weight, so
+    // the palette always needs at least one bone. With matrices, normals go
+    // through the same matrix and get renormalised, which is right as long
+    // as the bones don't scale unevenly.
+    //
+    struct SkinnedMesh
+    {
+        static constexpr size_t MAX_INFLUENCES = 4;
+
+        Vector3SoA positions, normals;
+        // bones[k][i] and weights[k][i] are the k'th influence on vertex i
+        std::vector<uint16_t> bones[MAX_INFLUENCES];
+        Vector3SoA::FloatArray weights[MAX_INFLUENCES];
+
+        explicit SkinnedMesh(size_t count = 0) {
+            Resize(count);
+        }
+
+        size_t Size() const { return positions.Size(); }
+
+        // New vertices start at the origin with no influences
+        void Resize(size_t count) {
+            size_t oldCount = Size();
+            positions.Resize(count);
+            normals.Resize(count);
+            for (size_t k = 0; k < MAX_INFLUENCES; ++k) {
+                // clear whatever used to be live, so the padding has no weight
+                // and only ever looks at bone 0
+                for (size_t i = count; i < oldCount; ++i) {
+                    bones[k][i] = 0;
+                    weights[k][i] = 0.0f;
+                }
+                bones[k].resize(positions.PaddedSize(), 0);
+                weights[k].resize(positions.PaddedSize(), 0.0f);
+            }
+        }
+
+        // influences is how many entries boneIndices and boneWeights hold, any
+        // beyond that up to MAX_INFLUENCES are set to nothing
+        void SetVertex(size_t i, const Vector3& position, const Vector3& normal,
+            const uint16_t* boneIndices, const float* boneWeights, size_t influences) {
+            positions.Set(i, position);
+            normals.Set(i, normal);
+            for (size_t k = 0; k < MAX_INFLUENCES; ++k) {
+                bones[k][i] = k < influences ? boneIndices[k] : 0;
+                weights[k][i] = k < influences ? boneWeights[k] : 0.0f;
+            }
+        }
+
+        // Weighted sum of vertex i's bone matrices
+        Matrix4 BlendedMatrix(const Matrix4* palette, size_t i) const {
+            Matrix4 m;
+            for (size_t k = 0; k < MAX_INFLUENCES; ++k) {
+                const Matrix4& bone = palette[bones[k][i]];
+                for (int c = 0; c < 4; ++c) {
+                    m.axis[c] += bone.axis[c] * weights[k][i];
+                }
+            }
+            return m;
+        }
+
+        // One vertex at a time, the straightforward way
+        void SkinVertex(const Matrix4* palette, size_t i, Vector3& position, Vector3& normal) const {
+            Matrix4 m = BlendedMatrix(palette, i);
+            Vector3 p = positions.Get(i), n = normals.Get(i);
+            Vector4 skinnedPosition = m * Vector4(p.x, p.y, p.z, 1);
+            Vector4 skinnedNormal = m * Vector4(n.x, n.y, n.z, 0);
+            position = Vector3(skinnedPosition.x, skinnedPosition.y, skinnedPosition.z);
+            normal = Vector3(skinnedNormal.x, skinnedNormal.y, skinnedNormal.z).Normalised();
+        }
+
+        // Skin every vertex into outPositions and outNormals, which get resized to match
+        void Skin(const Matrix4* palette, Vector3SoA& outPositions, Vector3SoA& outNormals) const {
+            SkinAll(palette, outPositions, outNormals, nullptr, 0);
+        }
+
+        // Skin() with the vertices split across the pool, grainSize at a time.
+        // Every vertex comes out the same as it would from the serial version.
+        void Skin(const Matrix4* palette, Vector3SoA& outPositions, Vector3SoA& outNormals, ThreadPool& pool, size_t grainSize = 1024) const {
+            SkinAll(palette, outPositions, outNormals, &pool, grainSize);
+        }
+
+        //
+        // DUAL QUATERNION SKINNING
+        //
+        // The same again with a palette of DualQuaternion's, half the size of
+        // the matrices. Each vertex's bones are blended with
+        // DualQuaternion::Blend, which keeps the result rigid, so joints
+        // twisting a long way don't collapse. Bones can't scale, and normals
+        // come out as long as they went in.
+        //
+
+        DualQuaternion BlendedDualQuaternion(const DualQuaternion* palette, size_t i) const {
+            uint16_t vertexBones[MAX_INFLUENCES];
+            float vertexWeights[MAX_INFLUENCES];
+            for (size_t k = 0; k < MAX_INFLUENCES; ++k) {
+                vertexBones[k] = bones[k][i];
+                vertexWeights[k] = weights[k][i];
+            }
+            return DualQuaternion::Blend(palette, vertexBones, vertexWeights, MAX_INFLUENCES);
+        }
+
+        // One vertex at a time, the straightforward way
+        void SkinVertex(const DualQuaternion* palette, size_t i, Vector3& position, Vector3& normal) const {
+            DualQuaternion dq = BlendedDualQuaternion(palette, i);
+            position = dq.TransformPoint(positions.Get(i));
+            normal = dq.TransformVector(normals.Get(i));
+        }
+
+        void Skin(const DualQuaternion* palette, Vector3SoA& outPositions, Vector3SoA& outNormals) const {
+            SkinAll(palette, outPositions, outNormals, nullptr, 0);
+        }
+
+        void Skin(const DualQuaternion* palette, Vector3SoA& outPositions, Vector3SoA& outNormals, ThreadPool& pool, size_t grainSize = 1024) const {
+            SkinAll(palette, outPositions, outNormals, &pool, grainSize);
+        }
+
+    private:
+        // vertices go through the SSE kernel in fours, which always fits the padding
+#if defined(MATHCLASSES_SSE)
+        static constexpr size_t BLOCK_SIZE = 4;
+#else
+        static constexpr size_t BLOCK_SIZE = 1;
+#endif
+
+        size_t BlockCount() const {
+            return positions.PaddedSize() / BLOCK_SIZE;
+        }
+
+        template <typename Bone>
+        void SkinAll(const Bone* palette, Vector3SoA& outPositions, Vector3SoA& outNormals, ThreadPool* pool, size_t grainSize) const {
+            outPositions.Resize(Size());
+            outNormals.Resize(Size());
+            if (pool == nullptr) {
+                SkinRange(palette, 0, BlockCount(), outPositions, outNormals);
+                return;
+            }
+            size_t blockGrain = (grainSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            pool->ParallelFor(0, BlockCount(), blockGrain, [this, palette, &outPositions, &outNormals](size_t begin, size_t end) {
+                SkinRange(palette, begin, end, outPositions, outNormals);
+            });
+        }
+
+        // Blocks [begin, end). Padding vertices have no weight, so they come
+        // out as zero and the outputs' padding stays zero.
+        void SkinRange(const Matrix4* palette, size_t begin, size_t end, Vector3SoA& outPositions, Vector3SoA& outNormals) const {
+#if defined(MATHCLASSES_SSE)
+            for (size_t block = begin; block < end; ++block) {
+                size_t first = block * BLOCK_SIZE;
+                __m128 p[BLOCK_SIZE], n[BLOCK_SIZE];
+                for (size_t j = 0; j < BLOCK_SIZE; ++j) {
+                    size_t i = first + j;
+
+                    // blend the columns of the bone matrices
+                    __m128 c[4];
+                    __m128 w = _mm_set1_ps(weights[0][i]);
+                    const Matrix4* bone = &palette[bones[0][i]];
+                    for (int col = 0; col < 4; ++col) {
+                        c[col] = _mm_mul_ps(bone->axis[col].simd, w);
+                    }
+                    for (size_t k = 1; k < MAX_INFLUENCES; ++k) {
+                        w = _mm_set1_ps(weights[k][i]);
+                        bone = &palette[bones[k][i]];
+                        for (int col = 0; col < 4; ++col) {
+                            c[col] = _mm_add_ps(c[col], _mm_mul_ps(bone->axis[col].simd, w));
+                        }
+                    }
+
+                    __m128 x = _mm_set1_ps(positions.x[i]), y = _mm_set1_ps(positions.y[i]), z = _mm_set1_ps(positions.z[i]);
+                    p[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], x), _mm_mul_ps(c[1], y)), _mm_add_ps(_mm_mul_ps(c[2], z), c[3]));
+                    x = _mm_set1_ps(normals.x[i]);
+                    y = _mm_set1_ps(normals.y[i]);
+                    z = _mm_set1_ps(normals.z[i]);
+                    n[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], x), _mm_mul_ps(c[1], y)), _mm_mul_ps(c[2], z));
+                }
+
+                // four (x, y, z, w) results into x, y and z registers
+                _MM_TRANSPOSE4_PS(p[0], p[1], p[2], p[3]);
+                _MM_TRANSPOSE4_PS(n[0], n[1], n[2], n[3]);
+                _mm_store_ps(&outPositions.x[first], p[0]);
+                _mm_store_ps(&outPositions.y[first], p[1]);
+                _mm_store_ps(&outPositions.z[first], p[2]);
+
+                // normalise, leaving zero normals at zero
+                __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0], n[0]), _mm_mul_ps(n[1], n[1])), _mm_mul_ps(n[2], n[2]));
+                __m128 nonZero = _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps());
+                __m128 scale = _mm_and_ps(nonZero, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSquared)));
+                _mm_store_ps(&outNormals.x[first], _mm_mul_ps(n[0], scale));
+                _mm_store_ps(&outNormals.y[first], _mm_mul_ps(n[1], scale));
+                _mm_store_ps(&outNormals.z[first], _mm_mul_ps(n[2], scale));
+            }
+#else
+            Vector3 position, normal;
+            for (size_t i = begin * BLOCK_SIZE; i < end * BLOCK_SIZE; ++i) {
+                SkinVertex(palette, i, position, normal);
+                outPositions.x[i] = position.x;
+                outPositions.y[i] = position.y;
+                outPositions.z[i] = position.z;
+                outNormals.x[i] = normal.x;
+                outNormals.y[i] = normal.y;
+                outNormals.z[i] = normal.z;
+            }
+#endif
+        }
+
+        void SkinRange(const DualQuaternion* palette, size_t begin, size_t end, Vector3SoA& outPositions, Vector3SoA& outNormals) const {
+#if defined(MATHCLASSES_SSE)
+            __m128 zero = _mm_setzero_ps(), two = _mm_set1_ps(2.0f);
+            for (size_t block = begin; block < end; ++block) {
+                size_t first = block * BLOCK_SIZE;
+
+                // blend each vertex's bones a whole quaternion at a time
+                __m128 real[BLOCK_SIZE], dual[BLOCK_SIZE];
+                for (size_t j = 0; j < BLOCK_SIZE; ++j) {
+                    size_t i = first + j;
+                    const Quaternion& pivot = palette[bones[0][i]].real;
+                    real[j] = dual[j] = zero;
+                    for (size_t k = 0; k < MAX_INFLUENCES; ++k) {
+                        const DualQuaternion& bone = palette[bones[k][i]];
+                        float w = pivot.Dot(bone.real) < 0.0f ? -weights[k][i] : weights[k][i];
+                        __m128 ws = _mm_set1_ps(w);
+                        real[j] = _mm_add_ps(real[j], _mm_mul_ps(_mm_load_ps(&bone.real.x), ws));
+                        dual[j] = _mm_add_ps(dual[j], _mm_mul_ps(_mm_load_ps(&bone.dual.x), ws));
+                    }
+                }
+
+                // then switch to four vertices a register for the rest
+                _MM_TRANSPOSE4_PS(real[0], real[1], real[2], real[3]);
+                _MM_TRANSPOSE4_PS(dual[0], dual[1], dual[2], dual[3]);
+                __m128 rx = real[0], ry = real[1], rz = real[2], rw = real[3];
+                __m128 dx = dual[0], dy = dual[1], dz = dual[2], dw = dual[3];
+
+                // normalise, leaving zero blends at zero
+                __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+                    _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw)));
+                __m128 scale = _mm_and_ps(_mm_cmpgt_ps(lengthSquared, zero), _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSquared)));
+                rx = _mm_mul_ps(rx, scale);
+                ry = _mm_mul_ps(ry, scale);
+                rz = _mm_mul_ps(rz, scale);
+                rw = _mm_mul_ps(rw, scale);
+                dx = _mm_mul_ps(dx, scale);
+                dy = _mm_mul_ps(dy, scale);
+                dz = _mm_mul_ps(dz, scale);
+                dw = _mm_mul_ps(dw, scale);
+
+                // translation = 2 (rw d - dw r + r x d), any of d along r cancels out
+                __m128 cx, cy, cz;
+                Cross(rx, ry, rz, dx, dy, dz, cx, cy, cz);
+                __m128 tx = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dx), _mm_mul_ps(dw, rx)), cx));
+                __m128 ty = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dy), _mm_mul_ps(dw, ry)), cy));
+                __m128 tz = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dz), _mm_mul_ps(dw, rz)), cz));
+
+                __m128 px, py, pz;
+                Rotate(rx, ry, rz, rw, _mm_load_ps(&positions.x[first]), _mm_load_ps(&positions.y[first]), _mm_load_ps(&positions.z[first]), px, py, pz);
+                _mm_store_ps(&outPositions.x[first], _mm_add_ps(px, tx));
+                _mm_store_ps(&outPositions.y[first], _mm_add_ps(py, ty));
+                _mm_store_ps(&outPositions.z[first], _mm_add_ps(pz, tz));
+
+                __m128 nx, ny, nz;
+                Rotate(rx, ry, rz, rw, _mm_load_ps(&normals.x[first]), _mm_load_ps(&normals.y[first]), _mm_load_ps(&normals.z[first]), nx, ny, nz);
+                _mm_store_ps(&outNormals.x[first], nx);
+                _mm_store_ps(&outNormals.y[first], ny);
+                _mm_store_ps(&outNormals.z[first], nz);
+            }
+#else
+            Vector3 position, normal;
+            for (size_t i = begin * BLOCK_SIZE; i < end * BLOCK_SIZE; ++i) {
+                SkinVertex(palette, i, position, normal);
+                outPositions.x[i] = position.x;
+                outPositions.y[i] = position.y;
+                outPositions.z[i] = position.z;
+                outNormals.x[i] = normal.x;
+                outNormals.y[i] = normal.y;
+                outNormals.z[i] = normal.z;
+            }
+#endif
+        }
+
+#if defined(MATHCLASSES_SSE)
+        // c = a x b, four vectors at a time
+        static void Cross(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz, __m128& cx, __m128& cy, __m128& cz) {
+            cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+            cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+            cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+        }
+
+        // Quaternion::Rotate, four at a time: v + 2w(q x v) + 2q x (q x v)
+        static void Rotate(__m128 qx, __m128 qy, __m128 qz, __m128 qw, __m128 vx, __m128 vy, __m128 vz, __m128& ox, __m128& oy, __m128& oz) {
+            __m128 two = _mm_set1_ps(2.0f);
+            __m128 tx, ty, tz, ux, uy, uz;
+            Cross(qx, qy, qz, vx, vy, vz, tx, ty, tz);
+            tx = _mm_mul_ps(tx, two);
+            ty = _mm_mul_ps(ty, two);
+            tz = _mm_mul_ps(tz, two);
+            Cross(qx, qy, qz, tx, ty, tz, ux, uy, uz);
+            ox = _mm_add_ps(_mm_add_ps(vx, _mm_mul_ps(tx, qw)), ux);
+            oy = _mm_add_ps(_mm_add_ps(vy, _mm_mul_ps(ty, qw)), uy);
+            oz = _mm_add_ps(_mm_add_ps(vz, _mm_mul_ps(tz, qw)), uz);
+        }
+#endif
+    };
+}
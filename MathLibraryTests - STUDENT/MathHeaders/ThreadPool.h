@@ -0,0 +1,213 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MathClasses
+{
+    //
+    // THREAD POOL
+    //
+    // A fixed set of worker threads for splitting loops over big arrays.
+    // ParallelFor cuts a range into chunks and deals them out to a queue per
+    // thread. Each thread works from the back of its own queue and, once that
+    // runs dry, steals from the front of the others, so uneven chunks even out.
+    //
+    // The thread calling ParallelFor joins in and only returns once every chunk
+    // is done. Only one thread should call ParallelFor on a pool at a time.
+    //
+    // If body throws, on any thread, the chunks not started yet are skipped
+    // and the first exception is rethrown from ParallelFor once the rest have
+    // finished, leaving the pool ready to use again.
+    //
+    struct ThreadPool
+    {
+        // workerCount extra threads, on top of whichever thread calls ParallelFor
+        explicit ThreadPool(size_t workerCount = DefaultWorkerCount()) : queues(workerCount + 1) {
+            for (std::unique_ptr<Queue>& queue : queues) {
+                queue.reset(new Queue());
+            }
+            for (size_t i = 0; i < workerCount; ++i) {
+                workers.emplace_back([this, i] { WorkerLoop(i); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator =(const ThreadPool&) = delete;
+
+        // Threads that take part in a ParallelFor, including the caller
+        size_t ThreadCount() const { return queues.size(); }
+
+        static size_t DefaultWorkerCount() {
+            unsigned int cores = std::thread::hardware_concurrency();
+            return cores > 1 ? cores - 1 : 0;
+        }
+
+        // Calls body(chunkBegin, chunkEnd) over [begin, end) in chunks of at
+        // most grainSize, spread over all the threads
+        template <typename F>
+        void ParallelFor(size_t begin, size_t end, size_t grainSize, F&& body) {
+            if (begin >= end) {
+                return;
+            }
+            if (grainSize == 0) {
+                grainSize = 1;
+            }
+
+            // not worth waking anyone for a single chunk
+            if (workers.empty() || end - begin <= grainSize) {
+                for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize) {
+                    body(chunkBegin, chunkBegin + grainSize < end ? chunkBegin + grainSize : end);
+                }
+                return;
+            }
+
+            std::function<void(size_t, size_t)> function(std::forward<F>(body));
+            job = &function;
+
+            size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+            remaining.store(chunkCount);
+            for (size_t c = 0; c < chunkCount; ++c) {
+                size_t chunkBegin = begin + c * grainSize;
+                size_t chunkEnd = chunkBegin + grainSize < end ? chunkBegin + grainSize : end;
+                Queue& queue = *queues[c % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.chunks.push_back(Chunk{ chunkBegin, chunkEnd });
+            }
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                queued.fetch_add(chunkCount);
+            }
+            wake.notify_all();
+
+            // the caller uses the last queue
+            size_t self = queues.size() - 1;
+            while (remaining.load() > 0) {
+                Chunk chunk;
+                if (TakeChunk(self, chunk)) {
+                    Run(chunk);
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+            job = nullptr;
+
+            if (failed.load()) {
+                std::exception_ptr thrown = error;
+                error = nullptr;
+                failed.store(false);
+                std::rethrow_exception(thrown);
+            }
+        }
+
+    private:
+        struct Chunk
+        {
+            size_t begin, end;
+        };
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Chunk> chunks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        // the body of the current ParallelFor
+        const std::function<void(size_t, size_t)>* job = nullptr;
+        // chunks not yet finished
+        std::atomic<size_t> remaining{ 0 };
+        // chunks not yet taken off a queue
+        std::atomic<size_t> queued{ 0 };
+
+        // set once a chunk throws, the rest are then skipped
+        std::atomic<bool> failed{ false };
+        // the first exception thrown, guarded by errorMutex
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        // Own queue first (newest chunk), then steal the oldest from everyone else
+        bool TakeChunk(size_t self, Chunk& chunk) {
+            if (queued.load() == 0) {
+                return false;
+            }
+            for (size_t n = 0; n < queues.size(); ++n) {
+                Queue& queue = *queues[(self + n) % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.chunks.empty()) {
+                    continue;
+                }
+                if (n == 0) {
+                    chunk = queue.chunks.back();
+                    queue.chunks.pop_back();
+                }
+                else {
+                    chunk = queue.chunks.front();
+                    queue.chunks.pop_front();
+                }
+                queued.fetch_sub(1);
+                return true;
+            }
+            return false;
+        }
+
+        // Always counts the chunk off, even if it's skipped or throws, so
+        // ParallelFor can't return while anyone is still using job
+        void Run(const Chunk& chunk) {
+            if (!failed.load()) {
+                try {
+                    (*job)(chunk.begin, chunk.end);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed.store(true);
+                }
+            }
+            remaining.fetch_sub(1);
+        }
+
+        void WorkerLoop(size_t self) {
+            for (;;) {
+                Chunk chunk;
+                if (TakeChunk(self, chunk)) {
+                    Run(chunk);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+                if (stopping) {
+                    return;
+                }
+            }
+        }
+    };
+}
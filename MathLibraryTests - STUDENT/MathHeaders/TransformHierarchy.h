@@ -0,0 +1,257 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+#include "Vector3.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "ThreadPool.h"
+
+namespace MathClasses
+{
+    //
+    // TRANSFORM HIERARCHY
+    //
+    // Parent/child transforms kept in flat arrays sorted by depth, so parents
+    // always come before their children and world matrices can be worked out
+    // in a single forward pass. Each node has a local position, rotation and
+    // scale, and world = parent world * local.
+    //
+    // Changing a node only marks it dirty. Update() then recomputes the world
+    // matrix of dirty nodes and everything below them, and leaves the rest alone.
+    //
+    // Nodes are referred to by the handle AddNode returns. Handles stay valid
+    // when the arrays get re-sorted, which happens on the next Update() after
+    // nodes are added.
+    //
+    struct TransformHierarchy
+    {
+        typedef size_t Node;
+
+        static constexpr Node NO_PARENT = static_cast<Node>(-1);
+
+        // Add a node under parent, or as a root. The parent must already exist.
+        Node AddNode(Node parent = NO_PARENT, const Vector3& position = Vector3(0, 0, 0),
+            const Quaternion& rotation = Quaternion(), const Vector3& scale = Vector3(1, 1, 1)) {
+            size_t index = positions.size();
+            size_t parentIndex = parent == NO_PARENT ? NO_PARENT : handleToIndex[parent];
+
+            positions.push_back(position);
+            rotations.push_back(rotation);
+            scales.push_back(scale);
+            parents.push_back(parentIndex);
+            depths.push_back(parentIndex == NO_PARENT ? 0 : depths[parentIndex] + 1);
+            worlds.push_back(Matrix4::MakeIdentity());
+            dirty.push_back(1);
+
+            Node handle = handleToIndex.size();
+            handleToIndex.push_back(index);
+            indexToHandle.push_back(handle);
+
+            sorted = false;
+            anyDirty = true;
+            return handle;
+        }
+
+        size_t Size() const { return positions.size(); }
+
+        Node GetParent(Node node) const {
+            size_t parent = parents[handleToIndex[node]];
+            return parent == NO_PARENT ? NO_PARENT : indexToHandle[parent];
+        }
+
+        // 0 for roots
+        size_t GetDepth(Node node) const { return depths[handleToIndex[node]]; }
+
+        // Number of distinct depths, as of the last Update()
+        size_t LevelCount() const { return levelStarts.empty() ? 0 : levelStarts.size() - 1; }
+
+        //
+        // Local transform
+
+        const Vector3& GetPosition(Node node) const { return positions[handleToIndex[node]]; }
+        const Quaternion& GetRotation(Node node) const { return rotations[handleToIndex[node]]; }
+        const Vector3& GetScale(Node node) const { return scales[handleToIndex[node]]; }
+
+        void SetPosition(Node node, const Vector3& position) {
+            size_t i = handleToIndex[node];
+            positions[i] = position;
+            MarkDirty(i);
+        }
+
+        void SetRotation(Node node, const Quaternion& rotation) {
+            size_t i = handleToIndex[node];
+            rotations[i] = rotation;
+            MarkDirty(i);
+        }
+
+        void SetScale(Node node, const Vector3& scale) {
+            size_t i = handleToIndex[node];
+            scales[i] = scale;
+            MarkDirty(i);
+        }
+
+        void SetLocal(Node node, const Vector3& position, const Quaternion& rotation, const Vector3& scale) {
+            size_t i = handleToIndex[node];
+            positions[i] = position;
+            rotations[i] = rotation;
+            scales[i] = scale;
+            MarkDirty(i);
+        }
+
+        // translation * rotation * scale
+        Matrix4 GetLocal(Node node) const {
+            size_t i = handleToIndex[node];
+            return Matrix4::MakeTRS(positions[i], rotations[i], scales[i]);
+        }
+
+        //
+        // World transform
+
+        // Brings the hierarchy up to date first if anything has changed
+        const Matrix4& GetWorld(Node node) {
+            Update();
+            return worlds[handleToIndex[node]];
+        }
+
+        // Recompute the world matrices of everything that changed since the last update
+        void Update() {
+            if (!anyDirty) {
+                return;
+            }
+            if (!sorted) {
+                Sort();
+            }
+
+            recomputed = UpdateRange(0, positions.size());
+            std::fill(dirty.begin(), dirty.end(), static_cast<unsigned char>(0));
+            anyDirty = false;
+        }
+
+        // Multithreaded Update(). Every node in a level only depends on the
+        // levels above it, so each level is split across the pool as one batch.
+        // Each node is worked out exactly as the serial version does it, so the
+        // results are identical whatever the thread count.
+        void Update(ThreadPool& pool, size_t grainSize = 256) {
+            if (!anyDirty) {
+                return;
+            }
+            if (!sorted) {
+                Sort();
+            }
+
+            std::atomic<size_t> count{ 0 };
+            for (size_t level = 0; level < LevelCount(); ++level) {
+                pool.ParallelFor(levelStarts[level], levelStarts[level + 1], grainSize, [this, &count](size_t begin, size_t end) {
+                    count.fetch_add(UpdateRange(begin, end));
+                });
+            }
+            recomputed = count.load();
+            std::fill(dirty.begin(), dirty.end(), static_cast<unsigned char>(0));
+            anyDirty = false;
+        }
+
+        // How many world matrices the last Update() had to recompute
+        size_t RecomputedCount() const { return recomputed; }
+
+    private:
+        // per node, in depth order
+        std::vector<Vector3> positions;
+        std::vector<Quaternion> rotations;
+        std::vector<Vector3> scales;
+        std::vector<size_t> parents;
+        std::vector<size_t> depths;
+        std::vector<Matrix4> worlds;
+        std::vector<unsigned char> dirty;
+
+        // handle <-> position in the arrays above
+        std::vector<size_t> handleToIndex;
+        std::vector<Node> indexToHandle;
+
+        // index of the first node at each depth, plus one past the end
+        std::vector<size_t> levelStarts;
+
+        // false until the next Update() after nodes are added
+        bool sorted = true;
+        bool anyDirty = false;
+        size_t recomputed = 0;
+
+        void MarkDirty(size_t i) {
+            dirty[i] = 1;
+            anyDirty = true;
+        }
+
+        // Pass dirty flags down from parents and recompute the dirty nodes in
+        // [begin, end). Parents must already be up to date. Returns how many changed.
+        size_t UpdateRange(size_t begin, size_t end) {
+            size_t count = 0;
+            for (size_t i = begin; i < end; ++i) {
+                size_t parent = parents[i];
+                if (parent != NO_PARENT && dirty[parent]) {
+                    dirty[i] = 1;
+                }
+                if (dirty[i]) {
+                    UpdateWorld(i);
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        void UpdateWorld(size_t i) {
+            Matrix4 local = Matrix4::MakeTRS(positions[i], rotations[i], scales[i]);
+            size_t parent = parents[i];
+            worlds[i] = parent == NO_PARENT ? local : worlds[parent] * local;
+        }
+
+        // Stable sort everything by depth, then fix up parents, handles and levels
+        void Sort() {
+            size_t count = positions.size();
+            std::vector<size_t> order(count);
+            std::iota(order.begin(), order.end(), static_cast<size_t>(0));
+            std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return depths[a] < depths[b]; });
+
+            std::vector<size_t> newIndex(count);
+            for (size_t i = 0; i < count; ++i) {
+                newIndex[order[i]] = i;
+            }
+
+            Permute(positions, order);
+            Permute(rotations, order);
+            Permute(scales, order);
+            Permute(depths, order);
+            Permute(worlds, order);
+            Permute(dirty, order);
+            Permute(parents, order);
+            Permute(indexToHandle, order);
+            for (size_t i = 0; i < count; ++i) {
+                if (parents[i] != NO_PARENT) {
+                    parents[i] = newIndex[parents[i]];
+                }
+                handleToIndex[indexToHandle[i]] = i;
+            }
+
+            levelStarts.clear();
+            for (size_t i = 0; i < count; ++i) {
+                while (levelStarts.size() <= depths[i]) {
+                    levelStarts.push_back(i);
+                }
+            }
+            levelStarts.push_back(count);
+            sorted = true;
+        }
+
+        template <typename T>
+        static void Permute(std::vector<T>& values, const std::vector<size_t>& order) {
+            std::vector<T> permuted;
+            permuted.reserve(values.size());
+            for (size_t i : order) {
+                permuted.push_back(values[i]);
+            }
+            values.swap(permuted);
+        }
+    };
+}
@@ -1,25 +1,71 @@
 #pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <string>
 
+#include "Simd.h"
+
 namespace MathClasses
 {
     //
-    // POINTS AND VECTORS
+    // How hard the fast normalise functions try. Worst case relative error in
+    // the resulting length, measured over random vectors:
+    //   Fast    - hardware reciprocal square root estimate, < 4e-4
+    //             (bit-trick estimate plus one Newton-Raphson step without SSE, < 2e-3)
+    //   Refined - estimate plus one Newton-Raphson step, < 5e-6
+    //   Exact   - sqrtf and a reciprocal multiply, within 1-2 ulp of dividing by
+    //             the length (so not always bit-identical to Normalise())
     //
-    struct Vector3
+    enum class NormaliseAccuracy
     {
-        float x, y, z;
+        Fast,
+        Refined,
+        Exact
+    };
 
-        // Default constructor
-        Vector3() : x{ 0 }, y{ 0 }, z{ 0 } {}
+    // 1 / sqrt(v) at the requested accuracy
+    inline float InverseSqrt(float v, NormaliseAccuracy accuracy) {
+        if (accuracy == NormaliseAccuracy::Exact) {
+            return 1.0f / sqrtf(v);
+        }
 
-        Vector3(float x, float y, float z) : x{ x }, y{ y }, z{ z } {}
+#ifdef MATHCLASSES_SSE
+        float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(v)));
+        if (accuracy == NormaliseAccuracy::Fast) {
+            return y;
+        }
+        return y * (1.5f - 0.5f * v * y * y);
+#else
+        // estimate from the float's bit pattern, then Newton-Raphson
+        unsigned int bits;
+        memcpy(&bits, &v, sizeof(bits));
+        bits = 0x5f375a86 - (bits >> 1);
+        float y;
+        memcpy(&y, &bits, sizeof(y));
+        y = y * (1.5f - 0.5f * v * y * y);
+        if (accuracy == NormaliseAccuracy::Fast) {
+            return y;
+        }
+        return y * (1.5f - 0.5f * v * y * y);
+#endif
+    }
 
+    //
+    // POINTS AND VECTORS
+    //
+    struct Vector3
+    {
         union {
             struct { float x, y, z; }; // 12-bytes
             float data[3]; // 12-bytes
         };
 
+        // Default constructor
+        Vector3() : data{ 0, 0, 0 } {}
+
+        Vector3(float x, float y, float z) : data{ x, y, z } {}
+
         float& operator [](int dim)
         {
             return data[dim];
@@ -154,9 +200,12 @@ namespace MathClasses
             return (*this - other).Magnitude();
         }
 
-        // Normalise the vector
+        // Normalise the vector, a zero vector is left untouched
         void Normalise() {
             float m = Magnitude();
+            if (m == 0.0f) {
+                return;
+            }
 
             x /= m;
             y /= m;
@@ -171,15 +220,89 @@ namespace MathClasses
             return copy;
         }
 
+        // Normalise with a reciprocal square root instead of sqrtf and three
+        // divides, see NormaliseAccuracy for the error at each level.
+        // A zero vector is left untouched.
+        void NormaliseFast(NormaliseAccuracy accuracy = NormaliseAccuracy::Refined) {
+            float m = MagnitudeSqr();
+            if (m == 0.0f) {
+                return;
+            }
+
+            float inv = InverseSqrt(m, accuracy);
+            x *= inv;
+            y *= inv;
+            z *= inv;
+        }
+
+        Vector3 NormalisedFast(NormaliseAccuracy accuracy = NormaliseAccuracy::Refined) const {
+            Vector3 copy = *this;
+            copy.NormaliseFast(accuracy);
+
+            return copy;
+        }
+
+        // Normalise count vectors in place, zero vectors are left untouched
+        static void Normalise(Vector3* vectors, size_t count, NormaliseAccuracy accuracy = NormaliseAccuracy::Refined) {
+            size_t i = 0;
+
+#ifdef MATHCLASSES_SSE
+            // four vectors at a time, their 12 floats loaded as three registers:
+            //   a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+            float* p = &vectors[0].x;
+            for (; i + 4 <= count; i += 4, p += 12) {
+                __m128 a = _mm_loadu_ps(p);
+                __m128 b = _mm_loadu_ps(p + 4);
+                __m128 c = _mm_loadu_ps(p + 8);
+
+                __m128 aa = _mm_mul_ps(a, a), bb = _mm_mul_ps(b, b), cc = _mm_mul_ps(c, c);
+
+                // gather the squares into per-vector x, y and z lanes and sum them
+                __m128 sx = _mm_shuffle_ps(_mm_shuffle_ps(aa, bb, _MM_SHUFFLE(2, 2, 3, 0)),
+                    _mm_shuffle_ps(bb, cc, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+                __m128 sy = _mm_shuffle_ps(_mm_shuffle_ps(aa, bb, _MM_SHUFFLE(0, 0, 1, 1)),
+                    _mm_shuffle_ps(bb, cc, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 sz = _mm_shuffle_ps(_mm_shuffle_ps(aa, bb, _MM_SHUFFLE(1, 1, 2, 2)),
+                    _mm_shuffle_ps(cc, cc, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 lenSqr = _mm_add_ps(_mm_add_ps(sx, sy), sz);
+
+                __m128 inv;
+                if (accuracy == NormaliseAccuracy::Exact) {
+                    inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lenSqr));
+                }
+                else {
+                    inv = _mm_rsqrt_ps(lenSqr);
+                    if (accuracy == NormaliseAccuracy::Refined) {
+                        __m128 yy = _mm_mul_ps(_mm_mul_ps(lenSqr, inv), inv);
+                        inv = _mm_mul_ps(inv, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), yy)));
+                    }
+                }
+
+                // zero vectors scale by 1
+                __m128 isZero = _mm_cmpeq_ps(lenSqr, _mm_setzero_ps());
+                inv = _mm_or_ps(_mm_andnot_ps(isZero, inv), _mm_and_ps(isZero, _mm_set1_ps(1.0f)));
+
+                // spread the four scales back out to match a, b and c
+                _mm_storeu_ps(p, _mm_mul_ps(a, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(1, 0, 0, 0))));
+                _mm_storeu_ps(p + 4, _mm_mul_ps(b, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(2, 2, 1, 1))));
+                _mm_storeu_ps(p + 8, _mm_mul_ps(c, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(3, 3, 3, 2))));
+            }
+#endif
+
+            for (; i < count; ++i) {
+                vectors[i].NormaliseFast(accuracy);
+            }
+        }
+
         //
         // DOT & CROSS PRODUCT
         //
 
-        float Dot(const Vector3& other) {
+        float Dot(const Vector3& other) const {
             return x * other.x + y * other.y + z * other.z;
         }
 
-        Vector3 Vector3::Cross(const Vector3& other) {
+        Vector3 Cross(const Vector3& other) const {
             return Vector3(y * other.z - z * other.y,
                 z * other.x - x * other.z,
                 x * other.y - y * other.x);
@@ -0,0 +1,253 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "Simd.h"
+#include "Vector3.h"
+
+namespace MathClasses
+{
+    //
+    // STRUCTURE-OF-ARRAYS VECTORS
+    //
+    // Stores many Vector3's as three separate x, y and z arrays so the bulk
+    // operations below can work on a full register of vectors at a time.
+    // The arrays are aligned and padded up to a multiple of FloatLanes::Width
+    // so kernels never need a scalar tail loop. Resize and Set keep the
+    // padding at zero, but kernels run over it too, so scaling by infinity
+    // say can leave NaN's there. Resize clears any slot it brings back into
+    // use, so new vectors always start at zero either way.
+    //
+    struct Vector3SoA
+    {
+        typedef std::vector<float, AlignedAllocator<float, 32>> FloatArray;
+
+        FloatArray x, y, z;
+
+        // Default constructor - empty
+        Vector3SoA() : count{ 0 } {}
+
+        // count zero vectors
+        explicit Vector3SoA(size_t count) : count{ 0 } {
+            Resize(count);
+        }
+
+        // copy from an array of structures
+        Vector3SoA(const Vector3* vectors, size_t count) : count{ 0 } {
+            Resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                x[i] = vectors[i].x;
+                y[i] = vectors[i].y;
+                z[i] = vectors[i].z;
+            }
+        }
+
+        explicit Vector3SoA(const std::vector<Vector3>& vectors) : Vector3SoA(vectors.data(), vectors.size()) {}
+
+        // copy back out to an array of structures
+        void ToVector(std::vector<Vector3>& out) const {
+            out.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                out[i].x = x[i];
+                out[i].y = y[i];
+                out[i].z = z[i];
+            }
+        }
+
+        std::vector<Vector3> ToVector() const {
+            std::vector<Vector3> out;
+            ToVector(out);
+            return out;
+        }
+
+        size_t Size() const { return count; }
+
+        // size of each array including the padding
+        size_t PaddedSize() const { return x.size(); }
+
+        void Resize(size_t newCount) {
+            size_t padded = (newCount + FloatLanes::Width - 1) / FloatLanes::Width * FloatLanes::Width;
+
+            // clear whatever used to be live so shrinking keeps the padding at
+            // zero, and whatever kernels left in the padding we're growing into
+            for (size_t i = newCount; i < count; ++i) {
+                x[i] = y[i] = z[i] = 0.0f;
+            }
+            for (size_t i = count; i < newCount && i < x.size(); ++i) {
+                x[i] = y[i] = z[i] = 0.0f;
+            }
+
+            x.resize(padded, 0.0f);
+            y.resize(padded, 0.0f);
+            z.resize(padded, 0.0f);
+            count = newCount;
+        }
+
+        Vector3 Get(size_t i) const {
+            assert(i < count);
+            return Vector3(x[i], y[i], z[i]);
+        }
+
+        void Set(size_t i, const Vector3& vec) {
+            assert(i < count);
+            x[i] = vec.x;
+            y[i] = vec.y;
+            z[i] = vec.z;
+        }
+
+        //
+        // BULK OPERATIONS
+        //
+        // out may be the same container as either input. The inputs must be the
+        // same size, out is resized to match.
+        //
+
+        // out = a + b, a and b must be the same size
+        static void Add(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out) {
+            assert(a.count == b.count);
+            out.Resize(a.count);
+            for (size_t i = 0; i < a.PaddedSize(); i += FloatLanes::Width) {
+                (FloatLanes::Load(&a.x[i]) + FloatLanes::Load(&b.x[i])).Store(&out.x[i]);
+                (FloatLanes::Load(&a.y[i]) + FloatLanes::Load(&b.y[i])).Store(&out.y[i]);
+                (FloatLanes::Load(&a.z[i]) + FloatLanes::Load(&b.z[i])).Store(&out.z[i]);
+            }
+        }
+
+        // out = a - b, a and b must be the same size
+        static void Subtract(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out) {
+            assert(a.count == b.count);
+            out.Resize(a.count);
+            for (size_t i = 0; i < a.PaddedSize(); i += FloatLanes::Width) {
+                (FloatLanes::Load(&a.x[i]) - FloatLanes::Load(&b.x[i])).Store(&out.x[i]);
+                (FloatLanes::Load(&a.y[i]) - FloatLanes::Load(&b.y[i])).Store(&out.y[i]);
+                (FloatLanes::Load(&a.z[i]) - FloatLanes::Load(&b.z[i])).Store(&out.z[i]);
+            }
+        }
+
+        // out = a * scale
+        static void Scale(const Vector3SoA& a, float scale, Vector3SoA& out) {
+            out.Resize(a.count);
+            FloatLanes s = FloatLanes::Set(scale);
+            for (size_t i = 0; i < a.PaddedSize(); i += FloatLanes::Width) {
+                (FloatLanes::Load(&a.x[i]) * s).Store(&out.x[i]);
+                (FloatLanes::Load(&a.y[i]) * s).Store(&out.y[i]);
+                (FloatLanes::Load(&a.z[i]) * s).Store(&out.z[i]);
+            }
+        }
+
+        // out = a + b * scale, e.g. position += velocity * deltaTime.
+        // a and b must be the same size.
+        static void MultiplyAdd(const Vector3SoA& a, const Vector3SoA& b, float scale, Vector3SoA& out) {
+            assert(a.count == b.count);
+            out.Resize(a.count);
+            FloatLanes s = FloatLanes::Set(scale);
+            for (size_t i = 0; i < a.PaddedSize(); i += FloatLanes::Width) {
+                (FloatLanes::Load(&a.x[i]) + FloatLanes::Load(&b.x[i]) * s).Store(&out.x[i]);
+                (FloatLanes::Load(&a.y[i]) + FloatLanes::Load(&b.y[i]) * s).Store(&out.y[i]);
+                (FloatLanes::Load(&a.z[i]) + FloatLanes::Load(&b.z[i]) * s).Store(&out.z[i]);
+            }
+        }
+
+        // out[i] = a[i] . b[i], a and b must be the same size and out must hold that many floats
+        static void Dot(const Vector3SoA& a, const Vector3SoA& b, float* out) {
+            assert(a.count == b.count);
+            size_t i = 0;
+            for (; i + FloatLanes::Width <= a.count; i += FloatLanes::Width) {
+                DotLanes(a, b, i).StoreUnaligned(&out[i]);
+            }
+            if (i < a.count) {
+                // last partial register goes through a temporary so we don't write past out
+                alignas(32) float tail[FloatLanes::Width];
+                DotLanes(a, b, i).Store(tail);
+                for (size_t j = 0; i + j < a.count; ++j) {
+                    out[i + j] = tail[j];
+                }
+            }
+        }
+
+        // out = a x b, a and b must be the same size
+        static void Cross(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out) {
+            assert(a.count == b.count);
+            out.Resize(a.count);
+            for (size_t i = 0; i < a.PaddedSize(); i += FloatLanes::Width) {
+                FloatLanes ax = FloatLanes::Load(&a.x[i]), ay = FloatLanes::Load(&a.y[i]), az = FloatLanes::Load(&a.z[i]);
+                FloatLanes bx = FloatLanes::Load(&b.x[i]), by = FloatLanes::Load(&b.y[i]), bz = FloatLanes::Load(&b.z[i]);
+
+                (ay * bz - az * by).Store(&out.x[i]);
+                (az * bx - ax * bz).Store(&out.y[i]);
+                (ax * by - ay * bx).Store(&out.z[i]);
+            }
+        }
+
+        // out[i] = |this[i]|, out must hold Size() floats
+        void Magnitude(float* out) const {
+            size_t i = 0;
+            for (; i + FloatLanes::Width <= count; i += FloatLanes::Width) {
+                FloatLanes::Sqrt(DotLanes(*this, *this, i)).StoreUnaligned(&out[i]);
+            }
+            if (i < count) {
+                alignas(32) float tail[FloatLanes::Width];
+                FloatLanes::Sqrt(DotLanes(*this, *this, i)).Store(tail);
+                for (size_t j = 0; i + j < count; ++j) {
+                    out[i + j] = tail[j];
+                }
+            }
+        }
+
+        // Normalise every vector, zero vectors are left untouched.
+        // See NormaliseAccuracy for the error of the faster levels.
+        void Normalise(NormaliseAccuracy accuracy = NormaliseAccuracy::Exact) {
+            FloatLanes zero = FloatLanes::Zero();
+            FloatLanes one = FloatLanes::Set(1.0f);
+            FloatLanes half = FloatLanes::Set(0.5f);
+            FloatLanes threeHalves = FloatLanes::Set(1.5f);
+            for (size_t i = 0; i < PaddedSize(); i += FloatLanes::Width) {
+                FloatLanes m = DotLanes(*this, *this, i);
+                FloatLanes inv;
+                if (accuracy == NormaliseAccuracy::Exact) {
+                    inv = one / FloatLanes::Sqrt(m);
+                }
+                else {
+                    inv = FloatLanes::RSqrt(m);
+                    if (accuracy == NormaliseAccuracy::Refined) {
+                        inv = inv * (threeHalves - half * m * inv * inv);
+                    }
+                }
+                inv = FloatLanes::Select(m > zero, inv, zero);
+
+                (FloatLanes::Load(&x[i]) * inv).Store(&x[i]);
+                (FloatLanes::Load(&y[i]) * inv).Store(&y[i]);
+                (FloatLanes::Load(&z[i]) * inv).Store(&z[i]);
+            }
+        }
+
+        // +=
+        Vector3SoA& operator +=(const Vector3SoA& rhs) {
+            Add(*this, rhs, *this);
+            return *this;
+        }
+
+        // -=
+        Vector3SoA& operator -=(const Vector3SoA& rhs) {
+            Subtract(*this, rhs, *this);
+            return *this;
+        }
+
+        // *=
+        Vector3SoA& operator *=(float rhs) {
+            Scale(*this, rhs, *this);
+            return *this;
+        }
+
+    private:
+        // number of live vectors, the arrays themselves may be longer
+        size_t count;
+
+        static FloatLanes DotLanes(const Vector3SoA& a, const Vector3SoA& b, size_t i) {
+            return FloatLanes::Load(&a.x[i]) * FloatLanes::Load(&b.x[i]) +
+                FloatLanes::Load(&a.y[i]) * FloatLanes::Load(&b.y[i]) +
+                FloatLanes::Load(&a.z[i]) * FloatLanes::Load(&b.z[i]);
+        }
+    };
+}
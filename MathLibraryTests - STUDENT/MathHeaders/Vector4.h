@@ -1,10 +1,229 @@
 #pragma once
+#include <cmath>
+#include <string>
+
+#include "Simd.h"
 
 namespace MathClasses
 {
-    struct Vector4
+    //
+    // HOMOGENEOUS POINTS AND VECTORS
+    //
+    // 16-byte aligned so the four floats map straight onto one SSE register.
+    //
+    struct alignas(16) Vector4
     {
-        // Add the struct data fields and methods, as per the tutorials and exercises, here...
-        // ...
-	};
-}
\ No newline at end of file
+        union {
+            struct { float x, y, z, w; }; // 16-bytes
+            float data[4]; // 16-bytes
+#ifdef MATHCLASSES_SSE
+            __m128 simd; // 16-bytes
+#endif
+        };
+
+        // Default constructor
+        Vector4() {
+#ifdef MATHCLASSES_SSE
+            simd = _mm_setzero_ps();
+#else
+            x = y = z = w = 0.0f;
+#endif
+        }
+
+        Vector4(float x, float y, float z, float w) {
+#ifdef MATHCLASSES_SSE
+            simd = _mm_set_ps(w, z, y, x);
+#else
+            this->x = x;
+            this->y = y;
+            this->z = z;
+            this->w = w;
+#endif
+        }
+
+#ifdef MATHCLASSES_SSE
+        // wrap an existing register
+        explicit Vector4(__m128 v) : simd{ v } {}
+#endif
+
+        float& operator [](int dim)
+        {
+            return data[dim];
+        }
+
+        const float& operator [](int dim) const
+        {
+            return data[dim];
+        }
+
+        // cast to float array
+        operator float* () { return data; }
+
+        // cast to float array - const-qualified
+        operator const float* () const { return data; }
+
+        // operator + (Vector, Vector)
+        Vector4 operator +(const Vector4& rhs) const {
+#ifdef MATHCLASSES_SSE
+            return Vector4(_mm_add_ps(simd, rhs.simd));
+#else
+            return Vector4(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w);
+#endif
+        }
+
+        // operator - (Vector, Vector)
+        Vector4 operator -(const Vector4& rhs) const {
+#ifdef MATHCLASSES_SSE
+            return Vector4(_mm_sub_ps(simd, rhs.simd));
+#else
+            return Vector4(x - rhs.x, y - rhs.y, z - rhs.z, w - rhs.w);
+#endif
+        }
+
+        // operator * (Vector, float)
+        Vector4 operator *(float rhs) const {
+#ifdef MATHCLASSES_SSE
+            return Vector4(_mm_mul_ps(simd, _mm_set1_ps(rhs)));
+#else
+            return Vector4(x * rhs, y * rhs, z * rhs, w * rhs);
+#endif
+        }
+
+        // operator * (Vector, Vector) - component-wise
+        Vector4 operator *(const Vector4& rhs) const {
+#ifdef MATHCLASSES_SSE
+            return Vector4(_mm_mul_ps(simd, rhs.simd));
+#else
+            return Vector4(x * rhs.x, y * rhs.y, z * rhs.z, w * rhs.w);
+#endif
+        }
+
+        // operator / (Vector, float)
+        Vector4 operator /(float rhs) const {
+#ifdef MATHCLASSES_SSE
+            return Vector4(_mm_div_ps(simd, _mm_set1_ps(rhs)));
+#else
+            return Vector4(x / rhs, y / rhs, z / rhs, w / rhs);
+#endif
+        }
+
+        // +=
+        Vector4& operator +=(const Vector4& rhs) {
+            *this = *this + rhs;
+            return *this;
+        }
+
+        // -=
+        Vector4& operator -=(const Vector4& rhs) {
+            *this = *this - rhs;
+            return *this;
+        }
+
+        // *=
+        Vector4& operator *=(float rhs) {
+            *this = *this * rhs;
+            return *this;
+        }
+
+        // /=
+        Vector4& operator /=(float rhs) {
+            *this = *this / rhs;
+            return *this;
+        }
+
+        bool operator == (const Vector4& rhs) const
+        {
+            const float THRESHOLD = 0.00001f;
+
+#ifdef MATHCLASSES_SSE
+            // clear the sign bit to get |a - b| for all four lanes at once
+            __m128 dist = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(simd, rhs.simd));
+            return _mm_movemask_ps(_mm_cmplt_ps(dist, _mm_set1_ps(THRESHOLD))) == 0xF;
+#else
+            return fabsf(x - rhs.x) < THRESHOLD && fabsf(y - rhs.y) < THRESHOLD &&
+                fabsf(z - rhs.z) < THRESHOLD && fabsf(w - rhs.w) < THRESHOLD;
+#endif
+        }
+
+        bool operator != (const Vector4& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        std::string ToString() const {
+            return std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ", " + std::to_string(w);
+        }
+
+        //
+        // MAGNITUDE & NORMALISATION
+        //
+
+        float Magnitude() const {
+            return sqrtf(MagnitudeSqr());
+        }
+
+        float MagnitudeSqr() const {
+            return Dot(*this);
+        }
+
+        float Distance(const Vector4& other) const {
+            return (*this - other).Magnitude();
+        }
+
+        // Normalise the vector, a zero vector is left untouched
+        void Normalise() {
+            float m = Magnitude();
+            if (m == 0.0f) {
+                return;
+            }
+            *this /= m;
+        }
+
+        // Returns a normalised copy of the Vector
+        Vector4 Normalised() const {
+            Vector4 copy = *this;
+            copy.Normalise();
+
+            return copy;
+        }
+
+        //
+        // DOT & CROSS PRODUCT
+        //
+
+        float Dot(const Vector4& other) const {
+#ifdef MATHCLASSES_SSE
+            __m128 m = _mm_mul_ps(simd, other.simd);
+            // (x + y, x + y, z + w, z + w) then fold the high pair onto the low pair
+            __m128 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+            s = _mm_add_ss(s, _mm_movehl_ps(s, s));
+            return _mm_cvtss_f32(s);
+#else
+            return (x * other.x + y * other.y) + (z * other.z + w * other.w);
+#endif
+        }
+
+        // 3D cross product of xyz, w is always 0 in the result
+        Vector4 Cross(const Vector4& other) const {
+#ifdef MATHCLASSES_SSE
+            __m128 a_yzx = _mm_shuffle_ps(simd, simd, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 b_yzx = _mm_shuffle_ps(other.simd, other.simd, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 a_zxy = _mm_shuffle_ps(simd, simd, _MM_SHUFFLE(3, 1, 0, 2));
+            __m128 b_zxy = _mm_shuffle_ps(other.simd, other.simd, _MM_SHUFFLE(3, 1, 0, 2));
+            __m128 c = _mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx));
+            // mask off w so inf/nan in the inputs can't leak into it
+            return Vector4(_mm_and_ps(c, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1))));
+#else
+            return Vector4(y * other.z - z * other.y,
+                z * other.x - x * other.z,
+                x * other.y - y * other.x,
+                0.0f);
+#endif
+        }
+    };
+
+    // operator * (float, Vector)
+    inline Vector4 operator *(float lhs, const Vector4& rhs) {
+        return rhs * lhs;
+    }
+}
@@ -123,6 +123,56 @@ namespace MathLibraryTests
 
 			Assert::AreEqual(Matrix3(1, 4, 7, 2, 5, 8, 3, 6, 9), m3a);
 		}
+		// determinant
+		TEST_METHOD(Determinant)
+		{
+			Matrix3 m3a(1, 4, 1,
+				2, 3, 2,
+				3, 2, 4);
+
+			Assert::AreEqual(-5.f, m3a.Determinant(), 0.0001f);
+			Assert::AreEqual(1.f, Matrix3::MakeIdentity().Determinant());
+		}
+		// inverse
+		TEST_METHOD(Inverse)
+		{
+			Matrix3 m3a(1, 4, 1,
+				2, 3, 2,
+				3, 2, 4);
+
+			Matrix3 actual = m3a.Inverse();
+
+			Assert::AreEqual(Matrix3(-1.6f, 2.8f, -1.0f, 0.4f, -0.2f, 0.0f, 1.0f, -2.0f, 1.0f), actual);
+			Assert::AreEqual(Matrix3::MakeIdentity(), m3a * actual);
+		}
+		// singular matrices give back zero
+		TEST_METHOD(InverseSingular)
+		{
+			Matrix3 m3a(1, 4, 1,
+				2, 3, 2,
+				3, 2, 3);
+
+			Assert::AreEqual(Matrix3(), m3a.Inverse());
+		}
+		// inverse-transpose of the 3x3 block of each model matrix
+		TEST_METHOD(ComputeNormalMatrices)
+		{
+			MathClasses::Matrix4 models[2] = {
+				MathClasses::Matrix4(2, 0, 0, 0,
+					0, 4, 0, 0,
+					0, 0, 0.5f, 0,
+					10, 20, 30, 1),
+				MathClasses::Matrix4(1, 4, 1, 0,
+					2, 3, 2, 0,
+					3, 2, 4, 0,
+					-5, 0, 5, 1)
+			};
+			Matrix3 actual[2];
+			Matrix3::ComputeNormalMatrices(models, actual, 2);
+
+			Assert::AreEqual(Matrix3(0.5f, 0, 0, 0, 0.25f, 0, 0, 0, 2), actual[0]);
+			Assert::AreEqual(Matrix3(1, 4, 1, 2, 3, 2, 3, 2, 4).Inverse().Transposed(), actual[1]);
+		}
 	};
 }
 
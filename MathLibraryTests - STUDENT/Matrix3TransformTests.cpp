@@ -97,6 +97,24 @@ namespace MathLibraryTests
 				actual);
 
 		}
+		// euler matches the product of the individual rotations
+		TEST_METHOD(MakeRotateEulerMatchesProduct)
+		{
+			Matrix3 expected = Matrix3::MakeRotateZ(-0.4f) * Matrix3::MakeRotateY(2.9f) * Matrix3::MakeRotateX(1.3f);
+			Matrix3 actual = Matrix3::MakeEuler(1.3f, 2.9f, -0.4f);
+
+			Assert::AreEqual(expected, actual);
+		}
+		// make rot from euler (batch)
+		TEST_METHOD(MakeRotateEulerBatch)
+		{
+			Vector3 angles[2] = { Vector3(1.0f, 2.0f, 3.0f), Vector3(-0.5f, 0.25f, 4.0f) };
+			Matrix3 actual[2];
+			Matrix3::MakeEuler(angles, actual, 2);
+
+			Assert::AreEqual(Matrix3::MakeEuler(angles[0]), actual[0]);
+			Assert::AreEqual(Matrix3::MakeEuler(angles[1]), actual[1]);
+		}
 		// make scale from floats
 		TEST_METHOD(MakeScaleFloat2D)
 		{
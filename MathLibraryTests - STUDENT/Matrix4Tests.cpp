@@ -6,6 +6,7 @@
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using ::MathClasses::Matrix4;
+using ::MathClasses::Vector3;
 using ::MathClasses::Vector4;
 
 namespace MathLibraryTests
@@ -134,6 +135,55 @@ namespace MathLibraryTests
                 38, 52, 38, 128),
                 actual);
         }
+        // mat4 += mat4
+        TEST_METHOD(OperatorPlusEqualsMat4)
+        {
+            Matrix4 m4a(1, 4, 1, 7,
+                2, 3, 2, 8,
+                3, 2, 3, 9,
+                4, 1, 4, 1);
+
+            Matrix4 m4b(4, 7, 3, 4,
+                5, 6, 4, 6,
+                6, 5, 6, 8,
+                7, 4, 5, 2);
+
+            Matrix4& result = (m4a += m4b);
+
+            Assert::AreEqual(Matrix4(5, 11, 4, 11,
+                7, 9, 6, 14,
+                9, 7, 9, 17,
+                11, 5, 9, 3),
+                m4a);
+            Assert::IsTrue(&result == &m4a);
+
+            // rhs is left alone
+            Assert::AreEqual(Matrix4(4, 7, 3, 4,
+                5, 6, 4, 6,
+                6, 5, 6, 8,
+                7, 4, 5, 2),
+                m4b);
+        }
+        // mat4 == mat4, differing in only one of the later elements
+        TEST_METHOD(OperatorEqualsLaterElements)
+        {
+            Matrix4 m4a(1, 4, 1, 7,
+                2, 3, 2, 8,
+                3, 2, 3, 9,
+                4, 1, 4, 1);
+
+            for (int i = 9; i < 16; ++i) {
+                Matrix4 m4b = m4a;
+                m4b[i] += 1.0f;
+
+                Assert::IsFalse(m4a == m4b);
+                Assert::IsTrue(m4a != m4b);
+            }
+
+            Matrix4 same = m4a;
+            Assert::IsTrue(m4a == same);
+            Assert::IsFalse(m4a != same);
+        }
         // make identity
         TEST_METHOD(MakeIdentity)
         {
@@ -160,6 +210,114 @@ namespace MathLibraryTests
             Assert::AreEqual(0.f, mat.m15);
             Assert::AreEqual(1.f, mat.m16);
         }
+        // batch points (vec3)
+        TEST_METHOD(TransformPointsVec3)
+        {
+            // scale by 2 then translate
+            Matrix4 m4a(2, 0, 0, 0,
+                0, 2, 0, 0,
+                0, 0, 2, 0,
+                55, 44, 99, 1);
+
+            Vector3 points[3] = { Vector3(1, 2, 3), Vector3(-4, 0, 0.5f), Vector3(0, 0, 0) };
+            Vector3 actual[3];
+            m4a.TransformPoints(points, actual, 3);
+
+            Assert::AreEqual(Vector3(57, 48, 105), actual[0]);
+            Assert::AreEqual(Vector3(47, 44, 100), actual[1]);
+            Assert::AreEqual(Vector3(55, 44, 99), actual[2]);
+        }
+        // batch directions (vec3, in place)
+        TEST_METHOD(TransformDirectionsVec3)
+        {
+            Matrix4 m4a(2, 0, 0, 0,
+                0, 2, 0, 0,
+                0, 0, 2, 0,
+                55, 44, 99, 1);
+
+            Vector3 dirs[2] = { Vector3(1, 2, 3), Vector3(-4, 0, 0.5f) };
+            m4a.TransformDirections(dirs, 2);
+
+            Assert::AreEqual(Vector3(2, 4, 6), dirs[0]);
+            Assert::AreEqual(Vector3(-8, 0, 1), dirs[1]);
+        }
+        // batch points (vec4) match mat4 * vec4
+        TEST_METHOD(TransformPointsVec4)
+        {
+            Matrix4 m4a(1, 4, 1, 7,
+                2, 3, 2, 8,
+                3, 2, 3, 9,
+                4, 1, 4, 1);
+
+            Vector4 points[2] = { Vector4(13.5f, -48.23f, -54, 1), Vector4(1, 2, 3, 0) };
+            Vector4 actual[2];
+            m4a.TransformPoints(points, actual, 2);
+
+            Assert::AreEqual(m4a * Vector4(13.5f, -48.23f, -54, 1), actual[0]);
+            Assert::AreEqual(m4a * Vector4(1, 2, 3, 1), actual[1]);
+        }
+        // determinant
+        TEST_METHOD(Determinant)
+        {
+            Matrix4 m4a(1, 4, 1, 7,
+                2, 3, 2, 8,
+                3, 2, 4, 9,
+                4, 1, 4, 1);
+
+            Assert::AreEqual(45.f, m4a.Determinant(), 0.0001f);
+            Assert::AreEqual(1.f, Matrix4::MakeIdentity().Determinant());
+        }
+        // general inverse
+        TEST_METHOD(Inverse)
+        {
+            Matrix4 m4a(1, 4, 1, 7,
+                2, 3, 2, 8,
+                3, 2, 4, 9,
+                4, 1, 4, 1);
+
+            Matrix4 actual = m4a.Inverse();
+            Matrix4 identity = Matrix4::MakeIdentity();
+            Matrix4 lhs = m4a * actual;
+            Matrix4 rhs = actual * m4a;
+
+            for (int i = 0; i < 16; ++i) {
+                Assert::AreEqual(identity[i], lhs[i], 0.0001f);
+                Assert::AreEqual(identity[i], rhs[i], 0.0001f);
+            }
+        }
+        // singular matrices give back zero
+        TEST_METHOD(InverseSingular)
+        {
+            Matrix4 m4a(1, 4, 1, 7,
+                2, 3, 2, 8,
+                3, 2, 3, 9,
+                4, 1, 4, 1);
+
+            Assert::AreEqual(Matrix4(), m4a.Inverse());
+        }
+        // affine inverse matches the general one
+        TEST_METHOD(InverseAffine)
+        {
+            // rotate, non-uniform scale and translate
+            Matrix4 m4a = Matrix4::MakeEuler(0.4f, -1.1f, 2.0f);
+            for (int i = 0; i < 4; ++i) {
+                m4a.mm[0][i] *= 2.0f;
+                m4a.mm[2][i] *= 0.5f;
+            }
+            m4a.m13 = 55;
+            m4a.m14 = -44;
+            m4a.m15 = 9.5f;
+
+            Matrix4 actual = m4a.InverseAffine();
+            Matrix4 expected = m4a.Inverse();
+            Matrix4 identity = Matrix4::MakeIdentity();
+            Matrix4 product = m4a * actual;
+
+            for (int i = 0; i < 16; ++i) {
+                Assert::AreEqual(expected[i], actual[i], 0.0001f);
+                Assert::AreEqual(identity[i], product[i], 0.0001f);
+            }
+        }
     };
 }
 namespace MathLibraryTests_OPTIONAL
@@ -3,9 +3,11 @@
 
 #include "Utils.h"
 #include "MathHeaders/Matrix4.h"
+#include "MathHeaders/Quaternion.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using ::MathClasses::Matrix4;
+using ::MathClasses::Quaternion;
 using ::MathClasses::Vector3;
 
 namespace MathLibraryTests
@@ -92,6 +94,24 @@ namespace MathLibraryTests
 					0.0f, 0.0f, 0.0f, 0.0f, 1.0f),
 				actual);
 		}
+		// euler matches the product of the individual rotations
+		TEST_METHOD(MakeRotateEulerMatchesProduct)
+		{
+			Matrix4 expected = Matrix4::MakeRotateZ(-0.4f) * Matrix4::MakeRotateY(2.9f) * Matrix4::MakeRotateX(1.3f);
+			Matrix4 actual = Matrix4::MakeEuler(1.3f, 2.9f, -0.4f);
+
+			Assert::AreEqual(expected, actual);
+		}
+		// make rot from euler (batch)
+		TEST_METHOD(MakeRotateEulerBatch)
+		{
+			Vector3 angles[2] = { Vector3(1.0f, 2.0f, 3.0f), Vector3(-0.5f, 0.25f, 4.0f) };
+			Matrix4 actual[2];
+			Matrix4::MakeEuler(angles, actual, 2);
+
+			Assert::AreEqual(Matrix4::MakeEuler(angles[0]), actual[0]);
+			Assert::AreEqual(Matrix4::MakeEuler(angles[1]), actual[1]);
+		}
 		// make scale from floats
 		TEST_METHOD(MakeScaleFloat3D)
 		{
@@ -115,5 +135,80 @@ namespace MathLibraryTests
 					0, 0, 4.0f, 0,
 					0, 0, 0, 1), actual);
 		}
+		// make TRS from euler angles
+		TEST_METHOD(MakeTRSEuler)
+		{
+			Vector3 t(1.0f, -2.0f, 3.0f), r(0.3f, -1.1f, 2.4f), s(2.0f, 0.5f, 3.0f);
+			Matrix4 expected = Matrix4::MakeTranslation(t) * Matrix4::MakeEuler(r) * Matrix4::MakeScale(s);
+
+			Assert::AreEqual(expected, Matrix4::MakeTRS(t, r, s));
+		}
+		// make TRS from a quaternion
+		TEST_METHOD(MakeTRSQuaternion)
+		{
+			Vector3 t(1.0f, -2.0f, 3.0f), r(0.3f, -1.1f, 2.4f), s(2.0f, 0.5f, 3.0f);
+			Matrix4 expected = Matrix4::MakeTranslation(t) * Matrix4::MakeEuler(r) * Matrix4::MakeScale(s);
+
+			Assert::AreEqual(expected, Matrix4::MakeTRS(t, Quaternion::MakeEuler(r), s));
+		}
+		// decompose gives back what went in
+		TEST_METHOD(Decompose)
+		{
+			Vector3 t(4.0f, 5.0f, -6.0f), s(1.5f, 2.0f, 0.25f);
+			Quaternion r = Quaternion::MakeEuler(2.1f, 0.4f, -2.8f);
+			Matrix4 m = Matrix4::MakeTRS(t, r, s);
+
+			Vector3 actualT, actualS;
+			Quaternion actualR;
+			Assert::IsTrue(m.Decompose(actualT, actualR, actualS));
+			Assert::AreEqual(t, actualT);
+			Assert::AreEqual(s, actualS);
+			// q and -q are the same rotation
+			Assert::IsTrue(actualR == r || actualR == -r);
+			Assert::AreEqual(m, Matrix4::MakeTRS(actualT, actualR, actualS));
+		}
+		// decompose a mirrored matrix
+		TEST_METHOD(DecomposeMirrored)
+		{
+			Matrix4 m = Matrix4::MakeTRS(Vector3(1, 2, 3), Quaternion::MakeEuler(0.5f, 1.0f, 1.5f), Vector3(2, -3, 4));
+
+			Vector3 t, s;
+			Quaternion r;
+			Assert::IsTrue(m.Decompose(t, r, s));
+			Assert::IsTrue(s.x < 0.0f);
+			Assert::AreEqual(1.0f, r.Magnitude(), 0.00001f);
+			Assert::AreEqual(m, Matrix4::MakeTRS(t, r, s));
+		}
+		// decompose with a zero scale
+		TEST_METHOD(DecomposeZeroScale)
+		{
+			Matrix4 m = Matrix4::MakeTRS(Vector3(1, 2, 3), Quaternion::MakeEuler(0.5f, 1.0f, 1.5f), Vector3(2, 0, 4));
+
+			Vector3 t, s;
+			Quaternion r(1, 2, 3, 4);
+			Assert::IsFalse(m.Decompose(t, r, s));
+			Assert::AreEqual(Vector3(1, 2, 3), t);
+			Assert::AreEqual(0.0f, s.y);
+			Assert::AreEqual(Quaternion(), r);
+		}
+		// make TRS and decompose (batch)
+		TEST_METHOD(TRSBatch)
+		{
+			Vector3 translations[3] = { Vector3(1, 2, 3), Vector3(-4, 0, 2), Vector3(0, 0, 0) };
+			Quaternion rotations[3] = { Quaternion::MakeEuler(0.1f, 0.2f, 0.3f), Quaternion::MakeEuler(-2.0f, 1.0f, 3.0f), Quaternion() };
+			Vector3 scales[3] = { Vector3(1, 1, 1), Vector3(0.5f, 2, 3), Vector3(0, 1, 1) };
+			Matrix4 matrices[3];
+			Matrix4::MakeTRS(translations, rotations, scales, matrices, 3);
+
+			Vector3 outT[3], outS[3];
+			Quaternion outR[3];
+			Assert::AreEqual((size_t)2, Matrix4::Decompose(matrices, outT, outR, outS, 3));
+			for (int i = 0; i < 3; ++i) {
+				Assert::AreEqual(Matrix4::MakeTRS(translations[i], rotations[i], scales[i]), matrices[i]);
+				Assert::AreEqual(translations[i], outT[i]);
+				Assert::AreEqual(scales[i], outS[i]);
+				Assert::AreEqual(matrices[i], Matrix4::MakeTRS(outT[i], outR[i], outS[i]));
+			}
+		}
 	};
 }
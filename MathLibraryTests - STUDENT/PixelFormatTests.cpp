@@ -0,0 +1,151 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/PixelFormat.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::Colour;
+using ::MathClasses::PixelConvert;
+using ::MathClasses::PixelFormat;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(PixelFormatTests)
+	{
+	public:
+		// not a multiple of any register width, so the scalar tail runs too
+		static const size_t COUNT = 11;
+
+		std::vector<Colour> MakeColours()
+		{
+			std::vector<Colour> colours(COUNT);
+			for (size_t i = 0; i < COUNT; ++i) {
+				colours[i] = Colour((unsigned char)(i * 23 + 1), (unsigned char)(i * 51 + 2), (unsigned char)(255 - i * 7), (unsigned char)(i * 19 + 3));
+			}
+			colours[0] = Colour(0, 0, 0, 0);
+			colours[1] = Colour(255, 255, 255, 255);
+			return colours;
+		}
+
+		// checks byte order and that converting back gives the original colours
+		void CheckByteOrder(PixelFormat format, int r, int g, int b, int a)
+		{
+			std::vector<Colour> colours = MakeColours();
+			std::vector<unsigned char> bytes(COUNT * 4);
+			PixelConvert::FromColour(colours.data(), bytes.data(), COUNT, format);
+
+			for (size_t i = 0; i < COUNT; ++i) {
+				Assert::AreEqual(colours[i].GetRed(), bytes[i * 4 + r]);
+				Assert::AreEqual(colours[i].GetGreen(), bytes[i * 4 + g]);
+				Assert::AreEqual(colours[i].GetBlue(), bytes[i * 4 + b]);
+				Assert::AreEqual(colours[i].GetAlpha(), bytes[i * 4 + a]);
+			}
+
+			std::vector<Colour> back(COUNT);
+			PixelConvert::ToColour(bytes.data(), back.data(), COUNT, format);
+			for (size_t i = 0; i < COUNT; ++i) {
+				Assert::AreEqual(colours[i], back[i]);
+			}
+		}
+
+		TEST_METHOD(RGBA8)
+		{
+			CheckByteOrder(PixelFormat::RGBA8, 0, 1, 2, 3);
+		}
+
+		TEST_METHOD(BGRA8)
+		{
+			CheckByteOrder(PixelFormat::BGRA8, 2, 1, 0, 3);
+		}
+
+		TEST_METHOD(ARGB8)
+		{
+			CheckByteOrder(PixelFormat::ARGB8, 1, 2, 3, 0);
+		}
+
+		TEST_METHOD(RGB565)
+		{
+			std::vector<Colour> colours = MakeColours();
+			std::vector<uint16_t> packed(COUNT);
+			PixelConvert::FromColour(colours.data(), packed.data(), COUNT, PixelFormat::RGB565);
+
+			Assert::AreEqual(0x0000, (int)packed[0]);
+			Assert::AreEqual(0xffff, (int)packed[1]);
+			for (size_t i = 0; i < COUNT; ++i) {
+				int expected = ((colours[i].GetRed() >> 3) << 11) | ((colours[i].GetGreen() >> 2) << 5) | (colours[i].GetBlue() >> 3);
+				Assert::AreEqual(expected, (int)packed[i]);
+			}
+
+			std::vector<Colour> back(COUNT);
+			PixelConvert::ToColour(packed.data(), back.data(), COUNT, PixelFormat::RGB565);
+			Assert::AreEqual(Colour(0, 0, 0, 255), back[0]);
+			Assert::AreEqual(Colour(255, 255, 255, 255), back[1]);
+			for (size_t i = 0; i < COUNT; ++i) {
+				// only the dropped low bits may differ
+				Assert::AreEqual(colours[i].GetRed() >> 3, back[i].GetRed() >> 3);
+				Assert::AreEqual(colours[i].GetGreen() >> 2, back[i].GetGreen() >> 2);
+				Assert::AreEqual(colours[i].GetBlue() >> 3, back[i].GetBlue() >> 3);
+				Assert::AreEqual((unsigned char)255, back[i].GetAlpha());
+			}
+		}
+
+		TEST_METHOD(RGBA4444)
+		{
+			std::vector<Colour> colours = MakeColours();
+			std::vector<uint16_t> packed(COUNT);
+			PixelConvert::FromColour(colours.data(), packed.data(), COUNT, PixelFormat::RGBA4444);
+
+			Assert::AreEqual(0x0000, (int)packed[0]);
+			Assert::AreEqual(0xffff, (int)packed[1]);
+
+			std::vector<Colour> back(COUNT);
+			PixelConvert::ToColour(packed.data(), back.data(), COUNT, PixelFormat::RGBA4444);
+			for (size_t i = 0; i < COUNT; ++i) {
+				// each nibble is repeated into the low half of its byte
+				Assert::AreEqual((colours[i].GetRed() >> 4) * 17, (int)back[i].GetRed());
+				Assert::AreEqual((colours[i].GetGreen() >> 4) * 17, (int)back[i].GetGreen());
+				Assert::AreEqual((colours[i].GetBlue() >> 4) * 17, (int)back[i].GetBlue());
+				Assert::AreEqual((colours[i].GetAlpha() >> 4) * 17, (int)back[i].GetAlpha());
+			}
+		}
+
+		TEST_METHOD(Float4)
+		{
+			std::vector<Colour> colours = MakeColours();
+			std::vector<float> floats(COUNT * 4);
+			PixelConvert::FromColour(colours.data(), floats.data(), COUNT, PixelFormat::Float4);
+
+			for (size_t i = 0; i < COUNT; ++i) {
+				Assert::AreEqual(colours[i].GetRed() / 255.0f, floats[i * 4 + 0], 0.000001f);
+				Assert::AreEqual(colours[i].GetGreen() / 255.0f, floats[i * 4 + 1], 0.000001f);
+				Assert::AreEqual(colours[i].GetBlue() / 255.0f, floats[i * 4 + 2], 0.000001f);
+				Assert::AreEqual(colours[i].GetAlpha() / 255.0f, floats[i * 4 + 3], 0.000001f);
+			}
+
+			std::vector<Colour> back(COUNT);
+			PixelConvert::ToColour(floats.data(), back.data(), COUNT, PixelFormat::Float4);
+			for (size_t i = 0; i < COUNT; ++i) {
+				Assert::AreEqual(colours[i], back[i]);
+			}
+		}
+
+		TEST_METHOD(Float4Clamps)
+		{
+			float floats[8 * 4];
+			for (int i = 0; i < 8 * 4; ++i) {
+				floats[i] = i % 2 == 0 ? -1.0f : 2.0f;
+			}
+			floats[4] = 0.5f;
+
+			Colour out[8];
+			PixelConvert::ToColour(floats, out, 8, PixelFormat::Float4);
+			Assert::AreEqual(Colour(0, 255, 0, 255), out[0]);
+			Assert::AreEqual(Colour(128, 255, 0, 255), out[1]);
+			Assert::AreEqual(Colour(0, 255, 0, 255), out[7]);
+		}
+	};
+}
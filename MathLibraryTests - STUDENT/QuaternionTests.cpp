@@ -0,0 +1,134 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/Quaternion.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::Quaternion;
+using ::MathClasses::Matrix3;
+using ::MathClasses::Matrix4;
+using ::MathClasses::Vector3;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(QuaternionTests)
+	{
+	public:
+		TEST_METHOD(DefaultConstructor)
+		{
+			Quaternion q;
+			Assert::AreEqual(Quaternion(0, 0, 0, 1), q);
+			Assert::AreEqual(Matrix3::MakeIdentity(), q.ToMatrix3());
+		}
+
+		TEST_METHOD(AxisAngleToMatrix)
+		{
+			// the library's MakeRotateZ turns the right-handed way
+			Quaternion q = Quaternion::MakeAxisAngle(Vector3(0, 0, 1), 0.72f);
+			Assert::AreEqual(Matrix3::MakeRotateZ(0.72f), q.ToMatrix3());
+			Assert::AreEqual(Matrix4::MakeRotateZ(0.72f), q.ToMatrix4());
+		}
+
+		TEST_METHOD(EulerToMatrix)
+		{
+			Quaternion q = Quaternion::MakeEuler(1.0f, 2.0f, 3.0f);
+			Assert::AreEqual(Matrix3::MakeEuler(1.0f, 2.0f, 3.0f), q.ToMatrix3());
+
+			q = Quaternion::MakeEuler(Vector3(-0.3f, 4.1f, 0.9f));
+			Assert::AreEqual(Matrix4::MakeEuler(-0.3f, 4.1f, 0.9f), q.ToMatrix4());
+		}
+
+		TEST_METHOD(FromMatrix)
+		{
+			// small turns, and nearly half turns about each axis so each of x, y and z gets to be the largest
+			Quaternion rotations[] = {
+				Quaternion::MakeEuler(0.4f, -1.1f, 2.0f),
+				Quaternion::MakeAxisAngle(Vector3(1, 0, 0), 3.0f),
+				Quaternion::MakeAxisAngle(Vector3(0, 1, 0), -3.0f),
+				Quaternion::MakeAxisAngle(Vector3(0, 0, 1), 3.1f),
+			};
+			for (const Quaternion& q : rotations) {
+				Quaternion actual = Quaternion::MakeFromMatrix(q.ToMatrix3());
+				Assert::IsTrue(actual == q || actual == -q);
+			}
+		}
+
+		TEST_METHOD(Multiply)
+		{
+			Quaternion a = Quaternion::MakeEuler(0.4f, -1.1f, 2.0f);
+			Quaternion b = Quaternion::MakeEuler(-2.5f, 0.3f, 0.8f);
+
+			// composes the same way as the matrices
+			Assert::AreEqual(a.ToMatrix3() * b.ToMatrix3(), (a * b).ToMatrix3());
+		}
+
+		TEST_METHOD(Rotate)
+		{
+			Quaternion q = Quaternion::MakeEuler(0.4f, -1.1f, 2.0f);
+			Vector3 v(13.5f, -48.23f, 862);
+
+			Vector3 expected = q.ToMatrix3() * v;
+			Vector3 actual = q.Rotate(v);
+			Assert::AreEqual(expected.x, actual.x, 0.001f);
+			Assert::AreEqual(expected.y, actual.y, 0.001f);
+			Assert::AreEqual(expected.z, actual.z, 0.001f);
+		}
+
+		TEST_METHOD(Inverse)
+		{
+			Quaternion q = Quaternion::MakeEuler(0.4f, -1.1f, 2.0f);
+			Assert::AreEqual(Quaternion::MakeIdentity(), q * q.Inverse());
+			Assert::AreEqual(Quaternion::MakeIdentity(), (q * 2.0f).Inverse() * (q * 2.0f));
+		}
+
+		TEST_METHOD(Normalise)
+		{
+			Quaternion q(1, 2, 3, 4);
+			q.Normalise();
+			Assert::AreEqual(1.0f, q.Magnitude(), 0.00001f);
+
+			Quaternion zero(0, 0, 0, 0);
+			Assert::AreEqual(zero, zero.Normalised());
+		}
+
+		TEST_METHOD(Slerp)
+		{
+			Vector3 axis(0, 0, 1);
+			Quaternion a = Quaternion::MakeAxisAngle(axis, 0.2f);
+			Quaternion b = Quaternion::MakeAxisAngle(axis, 1.4f);
+
+			Assert::AreEqual(a, Quaternion::Slerp(a, b, 0.0f));
+			Assert::AreEqual(b, Quaternion::Slerp(a, b, 1.0f));
+			Assert::AreEqual(Quaternion::MakeAxisAngle(axis, 0.5f), Quaternion::Slerp(a, b, 0.25f));
+
+			// takes the short way round when b is on the other hemisphere
+			Assert::AreEqual(Quaternion::MakeAxisAngle(axis, 0.5f), Quaternion::Slerp(a, -b, 0.25f));
+		}
+
+		TEST_METHOD(Nlerp)
+		{
+			Vector3 axis(0, 1, 0);
+			Quaternion a = Quaternion::MakeAxisAngle(axis, -0.6f);
+			Quaternion b = Quaternion::MakeAxisAngle(axis, 0.6f);
+
+			// symmetric about the midpoint, so nlerp and slerp agree there
+			Assert::AreEqual(Quaternion::MakeIdentity(), Quaternion::Nlerp(a, b, 0.5f));
+			Assert::AreEqual(1.0f, Quaternion::Nlerp(a, b, 0.3f).Magnitude(), 0.00001f);
+		}
+
+		TEST_METHOD(BatchToMatrix)
+		{
+			Quaternion q[2] = { Quaternion::MakeEuler(1.0f, 2.0f, 3.0f), Quaternion::MakeEuler(-0.5f, 0.25f, 4.0f) };
+			Matrix3 m3[2];
+			Matrix4 m4[2];
+			Quaternion::ToMatrix3(q, m3, 2);
+			Quaternion::ToMatrix4(q, m4, 2);
+
+			for (int i = 0; i < 2; ++i) {
+				Assert::AreEqual(q[i].ToMatrix3(), m3[i]);
+				Assert::AreEqual(q[i].ToMatrix4(), m4[i]);
+			}
+		}
+	};
+}
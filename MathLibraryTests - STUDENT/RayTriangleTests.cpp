@@ -0,0 +1,167 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/RayTriangle.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::RayHit;
+using ::MathClasses::RayHitSoA;
+using ::MathClasses::RayTriangle;
+using ::MathClasses::TriangleSoA;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector3SoA;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(RayTriangleTests)
+	{
+	public:
+		// a cloud of overlapping triangles around the origin, three vertices each
+		static std::vector<Vector3> MakeTriangles(size_t count)
+		{
+			std::vector<Vector3> vertices;
+			for (size_t i = 0; i < count; ++i) {
+				float t = (float)i;
+				Vector3 centre(sinf(t * 1.3f) * 4.0f, cosf(t * 0.7f) * 4.0f, sinf(t * 0.31f) * 4.0f);
+				vertices.push_back(centre + Vector3(sinf(t * 2.3f) * 2.0f, 1.5f, 0.3f));
+				vertices.push_back(centre + Vector3(-1.5f, cosf(t * 1.9f) * 2.0f, -0.4f));
+				vertices.push_back(centre + Vector3(0.6f, -1.2f, sinf(t * 0.9f) * 2.0f));
+			}
+			return vertices;
+		}
+
+		static Vector3 RayOrigin(int r)
+		{
+			float t = (float)r;
+			return Vector3(sinf(t * 0.37f) * 15.0f, cosf(t * 0.53f) * 15.0f, sinf(t * 0.71f + 2.0f) * 15.0f);
+		}
+
+		static Vector3 RayDirection(int r)
+		{
+			// roughly back towards the middle
+			float t = (float)r;
+			return Vector3(sinf(t * 1.1f) * 3.0f, cosf(t * 2.3f) * 3.0f, 0.5f) - RayOrigin(r);
+		}
+
+		static void AssertSameHit(const RayHit& expected, const RayHit& actual)
+		{
+			Assert::AreEqual(expected.triangle, actual.triangle);
+			Assert::AreEqual(expected.t, actual.t, 0.0001f);
+			Assert::AreEqual(expected.u, actual.u, 0.0001f);
+			Assert::AreEqual(expected.v, actual.v, 0.0001f);
+		}
+
+		TEST_METHOD(SingleTriangle)
+		{
+			Vector3 a(0, 0, 0), b(1, 0, 0), c(0, 1, 0);
+
+			RayHit hit;
+			Assert::IsFalse(hit.IsHit());
+			Assert::IsTrue(RayTriangle::Intersect(Vector3(0.25f, 0.5f, 2), Vector3(0, 0, -0.5f), a, b, c, hit, 7));
+			Assert::IsTrue(hit.IsHit());
+			Assert::AreEqual(4.0f, hit.t, 0.000001f);
+			Assert::AreEqual(0.25f, hit.u, 0.000001f);
+			Assert::AreEqual(0.5f, hit.v, 0.000001f);
+			Assert::AreEqual(7u, hit.triangle);
+
+			// from behind counts too
+			hit = RayHit();
+			Assert::IsTrue(RayTriangle::Intersect(Vector3(0.1f, 0.1f, -1), Vector3(0, 0, 1), a, b, c, hit));
+			Assert::AreEqual(1.0f, hit.t, 0.000001f);
+
+			// outside the edges, parallel, pointing away and too far
+			hit = RayHit();
+			Assert::IsFalse(RayTriangle::Intersect(Vector3(0.6f, 0.6f, 1), Vector3(0, 0, -1), a, b, c, hit));
+			Assert::IsFalse(RayTriangle::Intersect(Vector3(-1, 0.2f, 0), Vector3(1, 0, 0), a, b, c, hit));
+			Assert::IsFalse(RayTriangle::Intersect(Vector3(0.1f, 0.1f, 1), Vector3(0, 0, 1), a, b, c, hit));
+			hit = RayHit(0.5f);
+			Assert::IsFalse(RayTriangle::Intersect(Vector3(0.1f, 0.1f, 1), Vector3(0, 0, -1), a, b, c, hit));
+			Assert::IsFalse(hit.IsHit());
+			Assert::AreEqual(0.5f, hit.t);
+		}
+
+		TEST_METHOD(OneRayManyTriangles)
+		{
+			// odd count, so the last register is only part full
+			const size_t COUNT = 203;
+			std::vector<Vector3> vertices = MakeTriangles(COUNT);
+			TriangleSoA triangles(vertices.data(), COUNT);
+			Assert::AreEqual(COUNT, triangles.Size());
+
+			int hits = 0;
+			for (int r = 0; r < 64; ++r) {
+				Vector3 origin = RayOrigin(r), direction = RayDirection(r);
+				float maxT = r % 4 == 0 ? 0.8f : 10.0f;
+
+				RayHit expected(maxT);
+				for (size_t i = 0; i < COUNT; ++i) {
+					RayTriangle::Intersect(origin, direction, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], expected, (uint32_t)i);
+				}
+
+				RayHit actual(maxT);
+				Assert::AreEqual(expected.IsHit(), RayTriangle::IntersectNearest(origin, direction, triangles, actual));
+				if (expected.IsHit()) {
+					AssertSameHit(expected, actual);
+					++hits;
+				}
+				else {
+					Assert::AreEqual(maxT, actual.t);
+				}
+			}
+			// make sure both happened
+			Assert::IsTrue(hits > 10 && hits < 60);
+		}
+
+		TEST_METHOD(ManyRaysOneTriangle)
+		{
+			const size_t COUNT = 8;
+			const size_t RAYS = 77;
+			std::vector<Vector3> vertices = MakeTriangles(COUNT);
+
+			Vector3SoA origins(RAYS), directions(RAYS);
+			for (size_t r = 0; r < RAYS; ++r) {
+				origins.Set(r, RayOrigin((int)r));
+				directions.Set(r, RayDirection((int)r));
+			}
+
+			RayHitSoA hits(RAYS);
+			Assert::AreEqual(RAYS, hits.Size());
+			size_t updates = 0;
+			for (size_t i = 0; i < COUNT; ++i) {
+				updates += RayTriangle::Intersect(origins, directions, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], (uint32_t)i, hits);
+			}
+			Assert::IsTrue(updates > 0);
+
+			size_t hitCount = 0;
+			for (size_t r = 0; r < RAYS; ++r) {
+				RayHit expected;
+				for (size_t i = 0; i < COUNT; ++i) {
+					RayTriangle::Intersect(RayOrigin((int)r), RayDirection((int)r), vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], expected, (uint32_t)i);
+				}
+				RayHit actual = hits.Get(r);
+				Assert::AreEqual(expected.IsHit(), actual.IsHit());
+				if (expected.IsHit()) {
+					AssertSameHit(expected, actual);
+					++hitCount;
+				}
+			}
+			Assert::IsTrue(hitCount > 0 && hitCount < RAYS);
+		}
+
+		TEST_METHOD(DegenerateTrianglesMiss)
+		{
+			Vector3 vertices[] = {
+				Vector3(0, 0, 0), Vector3(1, 1, 1), Vector3(2, 2, 2),
+				Vector3(0, 0, 0), Vector3(0, 0, 0), Vector3(0, 0, 0),
+			};
+			TriangleSoA triangles(vertices, 2);
+
+			RayHit hit;
+			Assert::IsFalse(RayTriangle::IntersectNearest(Vector3(1, 0, 1), Vector3(-0.5f, 1, -0.5f), triangles, hit));
+			Assert::IsFalse(hit.IsHit());
+		}
+	};
+}
@@ -0,0 +1,217 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/Skinning.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::DualQuaternion;
+using ::MathClasses::Matrix4;
+using ::MathClasses::Quaternion;
+using ::MathClasses::SkinnedMesh;
+using ::MathClasses::ThreadPool;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector3SoA;
+using ::MathClasses::Vector4;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(SkinningTests)
+	{
+	public:
+		static std::vector<Matrix4> MakePalette(size_t count)
+		{
+			std::vector<Matrix4> palette(count);
+			for (size_t b = 0; b < count; ++b) {
+				float t = (float)b;
+				palette[b] = Matrix4::MakeEuler(t * 0.3f, t * -0.2f, t * 0.7f);
+				palette[b].axis[3] = Vector4(t, -t * 0.5f, 2.0f, 1);
+			}
+			return palette;
+		}
+
+		static std::vector<DualQuaternion> MakeDualPalette(size_t count)
+		{
+			std::vector<DualQuaternion> palette(count);
+			for (size_t b = 0; b < count; ++b) {
+				float t = (float)b;
+				Quaternion r = Quaternion::MakeEuler(t * 0.3f, t * -0.2f, t * 0.7f);
+				// some stored the other way round, which blending has to cope with
+				palette[b] = DualQuaternion::MakeRotationTranslation(b % 3 == 0 ? -r : r, Vector3(t, -t * 0.5f, 2.0f));
+			}
+			return palette;
+		}
+
+		// every vertex with between one and four influences, weights adding to 1
+		static SkinnedMesh MakeMesh(size_t count, size_t boneCount)
+		{
+			SkinnedMesh mesh(count);
+			for (size_t i = 0; i < count; ++i) {
+				float t = (float)i;
+				size_t influences = 1 + i % 4;
+				uint16_t bones[4];
+				float weights[4], total = 0.0f;
+				for (size_t k = 0; k < influences; ++k) {
+					bones[k] = (uint16_t)((i * 7 + k * 3) % boneCount);
+					weights[k] = 1.0f + k;
+					total += weights[k];
+				}
+				for (size_t k = 0; k < influences; ++k) {
+					weights[k] /= total;
+				}
+				mesh.SetVertex(i, Vector3(sinf(t), cosf(t * 0.3f), t * 0.01f),
+					Vector3(sinf(t * 2.0f), cosf(t * 2.0f), 0.5f).Normalised(), bones, weights, influences);
+			}
+			return mesh;
+		}
+
+		static void AssertNear(const Vector3& expected, const Vector3& actual)
+		{
+			for (int i = 0; i < 3; ++i) {
+				Assert::AreEqual(expected[i], actual[i], 0.00001f);
+			}
+		}
+
+		TEST_METHOD(SingleBone)
+		{
+			std::vector<Matrix4> palette = MakePalette(3);
+			SkinnedMesh mesh(1);
+			uint16_t bone = 2;
+			float weight = 1.0f;
+			mesh.SetVertex(0, Vector3(1, 2, 3), Vector3(0, 1, 0), &bone, &weight, 1);
+
+			Vector3SoA positions, normals;
+			mesh.Skin(palette.data(), positions, normals);
+			Assert::AreEqual((size_t)1, positions.Size());
+
+			Vector4 p = palette[2] * Vector4(1, 2, 3, 1);
+			Vector4 n = palette[2] * Vector4(0, 1, 0, 0);
+			AssertNear(Vector3(p.x, p.y, p.z), positions.Get(0));
+			AssertNear(Vector3(n.x, n.y, n.z), normals.Get(0));
+		}
+
+		TEST_METHOD(HalfAndHalf)
+		{
+			// halfway between two translations
+			std::vector<Matrix4> palette(2, Matrix4::MakeIdentity());
+			palette[0].axis[3] = Vector4(2, 0, 0, 1);
+			palette[1].axis[3] = Vector4(0, 4, 0, 1);
+
+			SkinnedMesh mesh(1);
+			uint16_t bones[] = { 0, 1 };
+			float weights[] = { 0.5f, 0.5f };
+			mesh.SetVertex(0, Vector3(1, 1, 1), Vector3(0, 0, 2), bones, weights, 2);
+
+			Vector3SoA positions, normals;
+			mesh.Skin(palette.data(), positions, normals);
+			AssertNear(Vector3(2, 3, 1), positions.Get(0));
+			// normalised on the way out
+			AssertNear(Vector3(0, 0, 1), normals.Get(0));
+		}
+
+		TEST_METHOD(MatchesPerVertex)
+		{
+			// odd count, so the last block is part padding
+			const size_t COUNT = 1001;
+			std::vector<Matrix4> palette = MakePalette(24);
+			SkinnedMesh mesh = MakeMesh(COUNT, palette.size());
+
+			Vector3SoA positions, normals;
+			mesh.Skin(palette.data(), positions, normals);
+			Assert::AreEqual(COUNT, positions.Size());
+			Assert::AreEqual(COUNT, normals.Size());
+
+			for (size_t i = 0; i < COUNT; ++i) {
+				Vector3 p, n;
+				mesh.SkinVertex(palette.data(), i, p, n);
+				AssertNear(p, positions.Get(i));
+				AssertNear(n, normals.Get(i));
+				Assert::AreEqual(1.0f, normals.Get(i).Magnitude(), 0.00001f);
+			}
+
+			// padding stays zero
+			for (size_t i = COUNT; i < positions.PaddedSize(); ++i) {
+				Assert::AreEqual(0.0f, positions.x[i]);
+				Assert::AreEqual(0.0f, normals.y[i]);
+			}
+		}
+
+		TEST_METHOD(ShrinkClearsInfluences)
+		{
+			SkinnedMesh mesh = MakeMesh(7, 3);
+			mesh.Resize(5);
+			for (size_t k = 0; k < SkinnedMesh::MAX_INFLUENCES; ++k) {
+				for (size_t i = 5; i < mesh.weights[k].size(); ++i) {
+					Assert::AreEqual(0.0f, mesh.weights[k][i]);
+					Assert::AreEqual(0, (int)mesh.bones[k][i]);
+				}
+			}
+		}
+
+		TEST_METHOD(ThreadedMatchesSerial)
+		{
+			const size_t COUNT = 10007;
+			std::vector<Matrix4> palette = MakePalette(60);
+			SkinnedMesh mesh = MakeMesh(COUNT, palette.size());
+
+			Vector3SoA positions, normals, threadedPositions, threadedNormals;
+			mesh.Skin(palette.data(), positions, normals);
+
+			ThreadPool pool(3);
+			// a grain that isn't a multiple of the block size
+			mesh.Skin(palette.data(), threadedPositions, threadedNormals, pool, 333);
+
+			Assert::AreEqual(0, memcmp(positions.x.data(), threadedPositions.x.data(), positions.PaddedSize() * sizeof(float)));
+			Assert::AreEqual(0, memcmp(positions.z.data(), threadedPositions.z.data(), positions.PaddedSize() * sizeof(float)));
+			Assert::AreEqual(0, memcmp(normals.y.data(), threadedNormals.y.data(), normals.PaddedSize() * sizeof(float)));
+		}
+
+		TEST_METHOD(DualQuaternionSingleBone)
+		{
+			std::vector<DualQuaternion> palette = MakeDualPalette(3);
+			SkinnedMesh mesh(1);
+			uint16_t bone = 1;
+			float weight = 1.0f;
+			mesh.SetVertex(0, Vector3(1, 2, 3), Vector3(0, 1, 0), &bone, &weight, 1);
+
+			Vector3SoA positions, normals;
+			mesh.Skin(palette.data(), positions, normals);
+			AssertNear(palette[1].TransformPoint(Vector3(1, 2, 3)), positions.Get(0));
+			AssertNear(palette[1].TransformVector(Vector3(0, 1, 0)), normals.Get(0));
+		}
+
+		TEST_METHOD(DualQuaternionMatchesPerVertex)
+		{
+			const size_t COUNT = 1001;
+			std::vector<DualQuaternion> palette = MakeDualPalette(24);
+			SkinnedMesh mesh = MakeMesh(COUNT, palette.size());
+
+			Vector3SoA positions, normals;
+			mesh.Skin(palette.data(), positions, normals);
+			Assert::AreEqual(COUNT, positions.Size());
+
+			for (size_t i = 0; i < COUNT; ++i) {
+				Vector3 p, n;
+				mesh.SkinVertex(palette.data(), i, p, n);
+				AssertNear(p, positions.Get(i));
+				AssertNear(n, normals.Get(i));
+				// rigid, so unit normals stay unit
+				Assert::AreEqual(1.0f, normals.Get(i).Magnitude(), 0.00001f);
+			}
+			for (size_t i = COUNT; i < positions.PaddedSize(); ++i) {
+				Assert::AreEqual(0.0f, positions.x[i]);
+				Assert::AreEqual(0.0f, normals.z[i]);
+			}
+
+			// threaded gives the same
+			ThreadPool pool(2);
+			Vector3SoA threadedPositions, threadedNormals;
+			mesh.Skin(palette.data(), threadedPositions, threadedNormals, pool, 100);
+			Assert::AreEqual(0, memcmp(positions.y.data(), threadedPositions.y.data(), positions.PaddedSize() * sizeof(float)));
+			Assert::AreEqual(0, memcmp(normals.x.data(), threadedNormals.x.data(), normals.PaddedSize() * sizeof(float)));
+		}
+	};
+}
@@ -0,0 +1,98 @@
+#include "CppUnitTest.h"
+
+#include "Utils.h"
+#include "MathHeaders/ThreadPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::ThreadPool;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(ThreadPoolTests)
+	{
+	public:
+		// every index is visited exactly once
+		static void CheckCoverage(ThreadPool& pool, size_t begin, size_t end, size_t grainSize)
+		{
+			std::vector<std::atomic<int>> visits(end);
+			for (std::atomic<int>& v : visits) {
+				v.store(0);
+			}
+
+			// asserts can't be made from the worker threads, so just record the largest chunk
+			std::atomic<size_t> largestChunk{ 0 };
+			pool.ParallelFor(begin, end, grainSize, [&visits, &largestChunk](size_t chunkBegin, size_t chunkEnd) {
+				size_t size = chunkEnd - chunkBegin;
+				size_t largest = largestChunk.load();
+				while (size > largest && !largestChunk.compare_exchange_weak(largest, size)) {
+				}
+				for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+					visits[i].fetch_add(1);
+				}
+			});
+			Assert::IsTrue(largestChunk.load() <= grainSize);
+
+			for (size_t i = 0; i < end; ++i) {
+				Assert::AreEqual(i < begin ? 0 : 1, visits[i].load());
+			}
+		}
+
+		TEST_METHOD(ParallelForCoversRange)
+		{
+			ThreadPool pool(3);
+			Assert::AreEqual((size_t)4, pool.ThreadCount());
+
+			CheckCoverage(pool, 0, 1000, 7);
+			CheckCoverage(pool, 13, 1000, 64);
+			CheckCoverage(pool, 0, 5, 100);
+			CheckCoverage(pool, 10, 10, 4);
+		}
+
+		TEST_METHOD(ReusedManyTimes)
+		{
+			ThreadPool pool(4);
+			std::atomic<size_t> total{ 0 };
+			for (int run = 0; run < 200; ++run) {
+				pool.ParallelFor(0, 100, 3, [&total](size_t b, size_t e) {
+					total.fetch_add(e - b);
+				});
+			}
+			Assert::AreEqual((size_t)20000, total.load());
+		}
+
+		TEST_METHOD(NoWorkers)
+		{
+			// everything runs on the calling thread
+			ThreadPool pool(0);
+			CheckCoverage(pool, 0, 100, 10);
+		}
+
+		TEST_METHOD(ExceptionRethrown)
+		{
+			ThreadPool pool(3);
+			// throws from the last chunk, which may be on any thread, then from lots of them
+			size_t throwEvery[] = { 1000, 7 };
+			for (size_t every : throwEvery) {
+				bool caught = false;
+				try {
+					pool.ParallelFor(0, 1000, 1, [every](size_t b, size_t) {
+						if ((b + 1) % every == 0) {
+							throw std::runtime_error("chunk failed");
+						}
+					});
+				}
+				catch (const std::runtime_error&) {
+					caught = true;
+				}
+				Assert::IsTrue(caught);
+
+				// nothing left over from the failed run, and the next one works as normal
+				CheckCoverage(pool, 0, 1000, 7);
+			}
+		}
+	};
+}
@@ -0,0 +1,153 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/TransformHierarchy.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::Matrix4;
+using ::MathClasses::Quaternion;
+using ::MathClasses::ThreadPool;
+using ::MathClasses::TransformHierarchy;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector4;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(TransformHierarchyTests)
+	{
+	public:
+		static void AssertMatrixNear(const Matrix4& expected, const Matrix4& actual)
+		{
+			for (int i = 0; i < 16; ++i) {
+				Assert::AreEqual(expected.v[i], actual.v[i], 0.0001f);
+			}
+		}
+
+		TEST_METHOD(LocalMatrix)
+		{
+			TransformHierarchy hierarchy;
+			Quaternion rotation = Quaternion::MakeEuler(0.3f, -1.2f, 2.0f);
+			TransformHierarchy::Node node = hierarchy.AddNode(TransformHierarchy::NO_PARENT, Vector3(1, 2, 3), rotation, Vector3(2, 3, 4));
+
+			// translate, then rotate, then scale when read right to left
+			Vector3 p(0.5f, -1, 2);
+			Vector3 expected = rotation.Rotate(Vector3(p.x * 2, p.y * 3, p.z * 4)) + Vector3(1, 2, 3);
+			Vector4 actual = hierarchy.GetLocal(node) * Vector4(p.x, p.y, p.z, 1);
+			Assert::AreEqual(expected, Vector3(actual.x, actual.y, actual.z));
+
+			AssertMatrixNear(hierarchy.GetLocal(node), hierarchy.GetWorld(node));
+		}
+
+		TEST_METHOD(WorldIsParentTimesLocal)
+		{
+			TransformHierarchy hierarchy;
+			TransformHierarchy::Node root = hierarchy.AddNode(TransformHierarchy::NO_PARENT, Vector3(10, 0, 0));
+			TransformHierarchy::Node child = hierarchy.AddNode(root, Vector3(0, 5, 0), Quaternion::MakeAxisAngle(Vector3(0, 0, 1), 1.5707963f));
+			TransformHierarchy::Node grandchild = hierarchy.AddNode(child, Vector3(2, 0, 0), Quaternion(), Vector3(3, 3, 3));
+
+			Assert::AreEqual((size_t)2, hierarchy.GetDepth(grandchild));
+			Assert::AreEqual(child, hierarchy.GetParent(grandchild));
+			Assert::AreEqual(TransformHierarchy::NO_PARENT, hierarchy.GetParent(root));
+
+			AssertMatrixNear(hierarchy.GetWorld(root) * hierarchy.GetLocal(child), hierarchy.GetWorld(child));
+			AssertMatrixNear(hierarchy.GetWorld(child) * hierarchy.GetLocal(grandchild), hierarchy.GetWorld(grandchild));
+
+			// the grandchild's origin is 2 along the child's x axis, which points up the world y axis
+			Vector4 origin = hierarchy.GetWorld(grandchild) * Vector4(0, 0, 0, 1);
+			Assert::AreEqual(Vector4(10, 7, 0, 1), origin);
+		}
+
+		TEST_METHOD(AddOutOfDepthOrder)
+		{
+			TransformHierarchy hierarchy;
+			TransformHierarchy::Node a = hierarchy.AddNode(TransformHierarchy::NO_PARENT, Vector3(1, 0, 0));
+			TransformHierarchy::Node b = hierarchy.AddNode(a, Vector3(0, 1, 0));
+			TransformHierarchy::Node c = hierarchy.AddNode(b, Vector3(0, 0, 1));
+			hierarchy.Update();
+			Assert::AreEqual((size_t)3, hierarchy.LevelCount());
+
+			// a new root and a new child of a both sort in front of c
+			TransformHierarchy::Node d = hierarchy.AddNode(TransformHierarchy::NO_PARENT, Vector3(5, 5, 5));
+			TransformHierarchy::Node e = hierarchy.AddNode(a, Vector3(0, 2, 0));
+			TransformHierarchy::Node f = hierarchy.AddNode(d, Vector3(1, 1, 1));
+
+			Assert::AreEqual(Vector4(1, 1, 1, 1), hierarchy.GetWorld(c) * Vector4(0, 0, 0, 1));
+			Assert::AreEqual(Vector4(1, 2, 0, 1), hierarchy.GetWorld(e) * Vector4(0, 0, 0, 1));
+			Assert::AreEqual(Vector4(6, 6, 6, 1), hierarchy.GetWorld(f) * Vector4(0, 0, 0, 1));
+			Assert::AreEqual(b, hierarchy.GetParent(c));
+			Assert::AreEqual(Vector3(5, 5, 5), hierarchy.GetPosition(d));
+		}
+
+		TEST_METHOD(OnlyDirtySubtreesRecompute)
+		{
+			// two roots with a chain of three below each
+			TransformHierarchy hierarchy;
+			TransformHierarchy::Node left = hierarchy.AddNode();
+			TransformHierarchy::Node right = hierarchy.AddNode();
+			TransformHierarchy::Node leftChain[3], rightChain[3];
+			for (int i = 0; i < 3; ++i) {
+				leftChain[i] = hierarchy.AddNode(i == 0 ? left : leftChain[i - 1], Vector3(1, 0, 0));
+				rightChain[i] = hierarchy.AddNode(i == 0 ? right : rightChain[i - 1], Vector3(0, 1, 0));
+			}
+			hierarchy.Update();
+			Assert::AreEqual((size_t)8, hierarchy.RecomputedCount());
+
+			// nothing changed, so nothing to do
+			hierarchy.Update();
+			Assert::AreEqual((size_t)8, hierarchy.RecomputedCount());
+
+			// moving the middle of the left chain only touches it and the node below
+			hierarchy.SetPosition(leftChain[1], Vector3(0, 0, 7));
+			hierarchy.Update();
+			Assert::AreEqual((size_t)2, hierarchy.RecomputedCount());
+			Assert::AreEqual(Vector4(2, 0, 7, 1), hierarchy.GetWorld(leftChain[2]) * Vector4(0, 0, 0, 1));
+
+			// moving a root touches its whole chain
+			hierarchy.SetRotation(right, Quaternion::MakeAxisAngle(Vector3(1, 0, 0), 3.14159265f));
+			hierarchy.Update();
+			Assert::AreEqual((size_t)4, hierarchy.RecomputedCount());
+			Assert::AreEqual(Vector4(0, -3, 0, 1), hierarchy.GetWorld(rightChain[2]) * Vector4(0, 0, 0, 1));
+			Assert::AreEqual(Vector4(2, 0, 7, 1), hierarchy.GetWorld(leftChain[2]) * Vector4(0, 0, 0, 1));
+		}
+
+		TEST_METHOD(ParallelUpdateMatchesSerial)
+		{
+			// the same random forest built twice
+			TransformHierarchy serial, parallel;
+			std::vector<TransformHierarchy::Node> nodes;
+			unsigned int seed = 12345;
+			auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+			for (int i = 0; i < 5000; ++i) {
+				TransformHierarchy::Node parent = i < 10 ? TransformHierarchy::NO_PARENT : nodes[next() % nodes.size()];
+				Vector3 position((float)(next() % 100) - 50, (float)(next() % 100) - 50, (float)(next() % 100) - 50);
+				Quaternion rotation = Quaternion::MakeEuler((next() % 628) / 100.0f, (next() % 628) / 100.0f, (next() % 628) / 100.0f);
+				Vector3 scale(1 + (next() % 10) / 10.0f, 1, 1 + (next() % 10) / 20.0f);
+				nodes.push_back(serial.AddNode(parent, position, rotation, scale));
+				parallel.AddNode(parent, position, rotation, scale);
+			}
+
+			ThreadPool pool(4);
+			for (int frame = 0; frame < 3; ++frame) {
+				serial.Update();
+				parallel.Update(pool, 32);
+				Assert::AreEqual(serial.RecomputedCount(), parallel.RecomputedCount());
+
+				for (TransformHierarchy::Node node : nodes) {
+					Assert::AreEqual(0, memcmp(&serial.GetWorld(node), &parallel.GetWorld(node), sizeof(Matrix4)));
+				}
+
+				// move a few nodes for the next frame
+				for (int i = 0; i < 50; ++i) {
+					TransformHierarchy::Node node = nodes[next() % nodes.size()];
+					Vector3 position((float)(next() % 100), 0, 1);
+					serial.SetPosition(node, position);
+					parallel.SetPosition(node, position);
+				}
+			}
+		}
+	};
+}
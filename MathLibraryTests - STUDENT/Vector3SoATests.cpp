@@ -0,0 +1,131 @@
+#include "CppUnitTest.h"
+#include "TestToString.h"
+
+#include "Utils.h"
+#include "MathHeaders/Vector3SoA.h"
+
+#include <limits>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using ::MathClasses::Vector3;
+using ::MathClasses::Vector3SoA;
+
+namespace MathLibraryTests
+{
+	TEST_CLASS(Vector3SoATests)
+	{
+	public:
+		// a count that isn't a multiple of any register width
+		std::vector<Vector3> MakeA()
+		{
+			return { Vector3(13.5f, -48.23f, 862), Vector3(1, 2, 3), Vector3(0, 0, 0),
+				Vector3(-4, 0.5f, 2), Vector3(243, -48.23f, 862) };
+		}
+
+		std::vector<Vector3> MakeB()
+		{
+			return { Vector3(5, 3.99f, -12), Vector3(3, 2, 1), Vector3(1, 1, 1),
+				Vector3(0, 0, -1), Vector3(0, 1, 0) };
+		}
+
+		TEST_METHOD(ConvertRoundTrip)
+		{
+			std::vector<Vector3> a = MakeA();
+			Vector3SoA soa(a);
+
+			Assert::AreEqual((size_t)5, soa.Size());
+			Assert::IsTrue(soa.PaddedSize() >= soa.Size());
+
+			std::vector<Vector3> back = soa.ToVector();
+			for (size_t i = 0; i < a.size(); ++i) {
+				Assert::AreEqual(a[i], back[i]);
+				Assert::AreEqual(a[i], soa.Get(i));
+			}
+		}
+
+		TEST_METHOD(GrowAfterScale)
+		{
+			// the kernel turns the zero padding into NaN's
+			Vector3SoA soa(MakeA());
+			Vector3SoA::Scale(soa, std::numeric_limits<float>::infinity(), soa);
+
+			size_t oldSize = soa.Size();
+			soa.Resize(soa.PaddedSize());
+			for (size_t i = oldSize; i < soa.Size(); ++i) {
+				Assert::AreEqual(Vector3(0, 0, 0), soa.Get(i));
+			}
+		}
+
+		TEST_METHOD(Add)
+		{
+			std::vector<Vector3> a = MakeA(), b = MakeB();
+			Vector3SoA out;
+			Vector3SoA::Add(Vector3SoA(a), Vector3SoA(b), out);
+
+			for (size_t i = 0; i < a.size(); ++i) {
+				Assert::AreEqual(a[i] + b[i], out.Get(i));
+			}
+		}
+
+		TEST_METHOD(MultiplyAdd)
+		{
+			std::vector<Vector3> a = MakeA(), b = MakeB();
+			Vector3SoA out(a);
+			Vector3SoA::MultiplyAdd(out, Vector3SoA(b), 0.5f, out);
+
+			for (size_t i = 0; i < a.size(); ++i) {
+				Assert::AreEqual(a[i] + b[i] * 0.5f, out.Get(i));
+			}
+		}
+
+		TEST_METHOD(Dot)
+		{
+			std::vector<Vector3> a = MakeA(), b = MakeB();
+			float out[5];
+			Vector3SoA::Dot(Vector3SoA(a), Vector3SoA(b), out);
+
+			for (size_t i = 0; i < a.size(); ++i) {
+				Assert::AreEqual(a[i].Dot(b[i]), out[i], 0.0001f);
+			}
+		}
+
+		TEST_METHOD(Cross)
+		{
+			std::vector<Vector3> a = MakeA(), b = MakeB();
+			Vector3SoA out;
+			Vector3SoA::Cross(Vector3SoA(a), Vector3SoA(b), out);
+
+			for (size_t i = 0; i < a.size(); ++i) {
+				// results run into the thousands, so the tolerance scales with the inputs
+				Vector3 expected = a[i].Cross(b[i]), actual = out.Get(i);
+				float tolerance = 1e-6f * (1.0f + a[i].Magnitude() * b[i].Magnitude());
+				for (int c = 0; c < 3; ++c) {
+					Assert::AreEqual(expected[c], actual[c], tolerance);
+				}
+			}
+		}
+
+		TEST_METHOD(Magnitude)
+		{
+			std::vector<Vector3> a = MakeA();
+			float out[5];
+			Vector3SoA(a).Magnitude(out);
+
+			for (size_t i = 0; i < a.size(); ++i) {
+				Assert::AreEqual(a[i].Magnitude(), out[i], 0.0001f);
+			}
+		}
+
+		TEST_METHOD(Normalise)
+		{
+			std::vector<Vector3> a = MakeA();
+			Vector3SoA soa(a);
+			soa.Normalise();
+
+			for (size_t i = 0; i < a.size(); ++i) {
+				Vector3 expected = a[i].MagnitudeSqr() > 0 ? a[i].Normalised() : Vector3(0, 0, 0);
+				Assert::AreEqual(expected, soa.Get(i));
+			}
+		}
+	};
+}
@@ -59,6 +59,41 @@ namespace MathLibraryTests
 			v3b.Normalise();
 			Assert::AreEqual(Vector3(0,0,0), v3b);
 		}		
+
+		TEST_METHOD(NormaliseFast)
+		{
+			using ::MathClasses::NormaliseAccuracy;
+
+			Vector3 v3a(13.5f, -48.23f, 862);
+			Vector3 expected(0.0156349f, -0.0558571f, 0.998316f);
+
+			Vector3 fast = v3a.NormalisedFast(NormaliseAccuracy::Fast);
+			Assert::AreEqual(1.f, fast.Magnitude(), 0.002f);
+
+			Assert::AreEqual(expected, v3a.NormalisedFast(NormaliseAccuracy::Refined));
+			Assert::AreEqual(expected, v3a.NormalisedFast(NormaliseAccuracy::Exact));
+
+			Vector3 v3b(0, 0, 0);
+			v3b.NormaliseFast();
+			Assert::AreEqual(Vector3(0, 0, 0), v3b);
+		}
+
+		TEST_METHOD(NormaliseBatch)
+		{
+			// enough for one four-wide block plus a remainder, with a zero vector in each
+			Vector3 vecs[6] = { Vector3(13.5f, -48.23f, 862), Vector3(0, 0, 0), Vector3(1, 2, 3),
+				Vector3(-4, 0.5f, 2), Vector3(0, 0, 0), Vector3(243, -48.23f, 862) };
+			Vector3 expected[6];
+			for (int i = 0; i < 6; ++i) {
+				expected[i] = vecs[i].Normalised();
+			}
+
+			Vector3::Normalise(vecs, 6);
+
+			for (int i = 0; i < 6; ++i) {
+				Assert::AreEqual(expected[i], vecs[i]);
+			}
+		}
 		
 		TEST_METHOD(Dot)
 		{